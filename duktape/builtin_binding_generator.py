@@ -62,8 +62,7 @@ def process_property(cls, prop):
 		duk_idx_t argc = duk_get_top(ctx);
 
 		duk_push_this(ctx);
-		duk_get_prop_string(ctx, -1, DUK_HIDDEN_SYMBOL("ptr"));
-		${class} *ptr = static_cast<${class} *>(duk_get_pointer(ctx, -1));
+		${class} *ptr = duk_get_builtin_ptr<${class}>(ctx, -1);
 		ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
 		if (argc) {
@@ -20,6 +20,33 @@ void DuktapeBindingHelper::fatal_function(void *udata, const char *msg) {
 #endif
 }
 
+extern "C" duk_bool_t ecmascript_exec_timeout_check(void *udata) {
+	return DuktapeBindingHelper::exec_timeout_check(udata);
+}
+
+bool DuktapeBindingHelper::exec_timeout_check(void *udata) {
+	DuktapeBindingHelper *self = get_singleton();
+	if (udata != self) {
+		// Worker heaps have their worker as udata, they have no time budget but are interrupted when terminated
+		return static_cast<DuktapeWorker *>(udata)->is_terminating();
+	}
+	if (0 == self->watchdog_deadline_usec) return false;
+	return OS::get_singleton()->get_ticks_usec() > self->watchdog_deadline_usec;
+}
+
+void DuktapeBindingHelper::duk_print_error(duk_context *ctx, duk_idx_t idx) {
+	if (duk_is_error(ctx, idx)) {
+		duk_get_prop_literal(ctx, idx, "stack");
+		if (duk_is_string(ctx, -1)) {
+			ERR_PRINTS(duk_get_godot_string(ctx, -1));
+			duk_pop(ctx);
+			return;
+		}
+		duk_pop(ctx);
+	}
+	ERR_PRINTS(duk_safe_to_string(ctx, idx));
+}
+
 duk_ret_t DuktapeBindingHelper::console_log_function(duk_context *ctx) {
 	int size = duk_get_top(ctx);
 	PoolStringArray args;
@@ -77,6 +104,7 @@ void DuktapeBindingHelper::set_strong_ref(ObjectID p_id, DuktapeHeapObject *ptr)
 		obj->get_script_instance_binding(get_language()->get_language_index());
 	}
 
+	duk_context *ctx = get_thread_context();
 	duk_push_strong_ref_container(ctx);
 	duk_push_heapptr(ctx, ptr);
 	duk_put_prop_index(ctx, -2, p_id);
@@ -124,6 +152,7 @@ duk_ret_t DuktapeBindingHelper::duk_godot_object_constructor(duk_context *ctx) {
 				inst->owner = obj;
 				inst->ecma_object = { duk_get_heapptr(ctx, -1) };
 				inst->script = get_language()->script_classes.get(ecma_class_name);
+				inst->script->instances.insert(obj);
 				obj->set_script_instance(inst);
 			}
 		}
@@ -164,6 +193,7 @@ void DuktapeBindingHelper::godot_refcount_incremented(Reference *p_object) {
 }
 
 bool DuktapeBindingHelper::godot_refcount_decremented(Reference *p_object) {
+	HeapLock lock(this);
 	int refcount = p_object->reference_get_count();
 	ECMAScriptBindingData *gc_handler = static_cast<ECMAScriptBindingData *>(p_object->get_script_instance_binding(get_language()->get_language_index()));
 	if (gc_handler) {
@@ -180,53 +210,140 @@ bool DuktapeBindingHelper::godot_refcount_decremented(Reference *p_object) {
 Error DuktapeBindingHelper::eval_string(const String &p_source) {
 	ERR_FAIL_COND_V(Thread::get_caller_id() != Thread::get_main_id(), ERR_UNAVAILABLE);
 	ERR_FAIL_NULL_V(ctx, ERR_SKIP);
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
+	// Libraries run as the module of their path so their require is relative to them
+	Ref<ECMAScriptLibrary> lib = ECMAScriptLibraryResourceLoader::get_loading_library();
+	const String source = lib.is_null() ? p_source : wrap_module_source(p_source);
 #ifdef DEBUG_ENABLED
 	String filename = "";
-	Ref<ECMAScriptLibrary> lib = ECMAScriptLibraryResourceLoader::get_loading_library();
 	if (!lib.is_null()) {
 		filename = ProjectSettings::get_singleton()->globalize_path(lib->get_path());
 		filename = filename.replace(ProjectSettings::get_singleton()->globalize_path("res://"), "");
 	}
-	duk_push_godot_string(ctx, p_source);
+	duk_push_godot_string(ctx, source);
 	duk_push_godot_string(ctx, filename);
-	duk_compile(ctx, DUK_COMPILE_EVAL);
-	duk_call(ctx, 0);
+	// Errors, including a refused allocation over the heap limit, must not reach the fatal handler
+	bool failed = DUK_EXEC_SUCCESS != duk_pcompile(ctx, DUK_COMPILE_EVAL);
 #else
-	duk_eval_string(ctx, p_source.utf8().ptr());
+	bool failed = DUK_EXEC_SUCCESS != duk_pcompile_string(ctx, DUK_COMPILE_EVAL, source.utf8().ptr());
 #endif
-	return OK;
+	if (!failed) {
+		// Compiling doesn't count against the time budget
+		WatchdogScope watchdog(this);
+		failed = DUK_EXEC_SUCCESS != duk_pcall(ctx, 0);
+		if (!failed && !lib.is_null()) {
+			failed = !duk_call_module_function(ctx, lib->get_path());
+		}
+	}
+	if (failed) {
+		duk_print_error(ctx, -1);
+	}
+	duk_pop(ctx);
+	return failed ? ERR_INVALID_DATA : OK;
 }
 
 Error DuktapeBindingHelper::safe_eval_text(const String &p_source, String &r_error) {
 	ERR_FAIL_COND_V(Thread::get_caller_id() != Thread::get_main_id(), ERR_UNAVAILABLE);
 	ERR_FAIL_NULL_V(ctx, ERR_SKIP);
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
+	Ref<ECMAScriptLibrary> lib = ECMAScriptLibraryResourceLoader::get_loading_library();
+	const String source = lib.is_null() ? p_source : wrap_module_source(p_source);
 #ifdef DEBUG_ENABLED
 	String filename = "";
-	Ref<ECMAScriptLibrary> lib = ECMAScriptLibraryResourceLoader::get_loading_library();
 	if (!lib.is_null()) {
 		filename = ProjectSettings::get_singleton()->globalize_path(lib->get_path());
 	}
-	duk_push_godot_string(ctx, p_source);
+	duk_push_godot_string(ctx, source);
 	duk_push_godot_string(ctx, filename);
-	if (OK != duk_pcompile(ctx, DUK_COMPILE_EVAL)) {
+	bool failed = DUK_EXEC_SUCCESS != duk_pcompile(ctx, DUK_COMPILE_EVAL);
+#else
+	bool failed = DUK_EXEC_SUCCESS != duk_pcompile_string(ctx, DUK_COMPILE_EVAL, source.utf8().ptr());
+#endif
+	if (!failed) {
+		WatchdogScope watchdog(this);
+		failed = DUK_EXEC_SUCCESS != duk_pcall(ctx, 0);
+		if (!failed && !lib.is_null()) {
+			failed = !duk_call_module_function(ctx, lib->get_path());
+		}
+	}
+	if (failed) {
 		r_error = duk_safe_to_string(ctx, -1);
-		return ERR_INVALID_DATA;
 	}
+	duk_pop(ctx);
+	return failed ? ERR_INVALID_DATA : OK;
+}
 
-	if (DUK_EXEC_SUCCESS != duk_pcall(ctx, 0)) {
-		r_error = duk_safe_to_string(ctx, -1);
-		return ERR_INVALID_DATA;
+uint32_t DuktapeBindingHelper::get_bytecode_version() const {
+	// The dump format is only stable within a Duktape release
+	return DUK_VERSION;
+}
+
+Error DuktapeBindingHelper::compile_to_bytecode(const String &p_source, const String &p_path, Vector<uint8_t> &r_bytecode) {
+	ERR_FAIL_COND_V(Thread::get_caller_id() != Thread::get_main_id(), ERR_UNAVAILABLE);
+	ERR_FAIL_NULL_V(ctx, ERR_SKIP);
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
+
+	// Only libraries are precompiled, they are wrapped like in eval_string and run by eval_bytecode
+	String filename = ProjectSettings::get_singleton()->globalize_path(p_path);
+	filename = filename.replace(ProjectSettings::get_singleton()->globalize_path("res://"), "");
+	duk_push_godot_string(ctx, wrap_module_source(p_source));
+	duk_push_godot_string(ctx, filename);
+	if (OK != duk_pcompile(ctx, DUK_COMPILE_EVAL)) {
+		ERR_PRINTS(p_path + ": " + duk_safe_to_string(ctx, -1));
+		duk_pop(ctx);
+		return ERR_PARSE_ERROR;
 	}
-#else
-	if (OK != duk_peval_string(ctx, p_source.utf8().ptr())) {
-		r_error = duk_safe_to_string(ctx, -1);
-		return ERR_INVALID_DATA;
+
+	duk_dump_function(ctx);
+	duk_size_t size = 0;
+	const void *data = duk_get_buffer(ctx, -1, &size);
+	r_bytecode.resize(size);
+	copymem(r_bytecode.ptrw(), data, size);
+	duk_pop(ctx);
+	return OK;
+}
+
+duk_ret_t DuktapeBindingHelper::safe_load_function(duk_context *ctx, void *udata) {
+	duk_load_function(ctx);
+	return 1;
+}
+
+Error DuktapeBindingHelper::eval_bytecode(const Vector<uint8_t> &p_bytecode) {
+	ERR_FAIL_COND_V(Thread::get_caller_id() != Thread::get_main_id(), ERR_UNAVAILABLE);
+	ERR_FAIL_NULL_V(ctx, ERR_SKIP);
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
+	ERR_FAIL_COND_V(p_bytecode.empty(), ERR_INVALID_DATA);
+
+	void *buffer = duk_push_fixed_buffer(ctx, p_bytecode.size());
+	copymem(buffer, p_bytecode.ptr(), p_bytecode.size());
+	// Duktape only checks the leading marker of the dump, the caller must validate the content
+	if (DUK_EXEC_SUCCESS != duk_safe_call(ctx, safe_load_function, NULL, 1, 1)) {
+		duk_pop(ctx);
+		return ERR_FILE_CORRUPT;
 	}
-#endif
+
+	WatchdogScope watchdog(this);
+	bool failed = DUK_EXEC_SUCCESS != duk_pcall(ctx, 0);
+	// The program evaluates to the module function of the library
+	Ref<ECMAScriptLibrary> lib = ECMAScriptLibraryResourceLoader::get_loading_library();
+	if (!failed && !lib.is_null() && duk_is_function(ctx, -1)) {
+		failed = !duk_call_module_function(ctx, lib->get_path());
+	}
+	if (failed) {
+		duk_print_error(ctx, -1);
+		duk_pop(ctx);
+		return ERR_SCRIPT_FAILED;
+	}
+	duk_pop(ctx);
 	return OK;
 }
 
 void *DuktapeBindingHelper::alloc_object_binding_data(Object *p_object) {
+	HeapLock lock(this);
 	ECMAScriptBindingData *handler = NULL;
 	if (DuktapeHeapObject *heap_ptr = get_strong_ref(p_object)) {
 		handler = memnew(ECMAScriptBindingData);
@@ -239,6 +356,7 @@ void *DuktapeBindingHelper::alloc_object_binding_data(Object *p_object) {
 
 void DuktapeBindingHelper::free_object_binding_data(void *p_gc_handler) {
 	if (ECMAScriptBindingData *handler = static_cast<ECMAScriptBindingData *>(p_gc_handler)) {
+		HeapLock lock(this);
 		if (Object::cast_to<Reference>(handler->godot_object)) {
 			// References don't need do this as they are weak referenced or they
 			return;
@@ -258,40 +376,44 @@ duk_ret_t DuktapeBindingHelper::godot_object_free(duk_context *ctx) {
 		ERR_FAIL_V(DUK_ERR_TYPE_ERROR);
 	} else {
 		memdelete(obj);
-		duk_del_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
+		duk_set_native_slot(ctx, -1, NULL, Variant::OBJECT);
 	}
 	return DUK_NO_RET_VAL;
 }
 
 duk_ret_t DuktapeBindingHelper::duk_godot_object_method(duk_context *ctx) {
 
+	ECMASCRIPT_STATS_INCREMENT(native_calls);
 	duk_idx_t argc = duk_get_top(ctx);
 
 	duk_push_current_function(ctx);
-	duk_get_prop_string(ctx, -1, DUK_HIDDEN_SYMBOL("mb"));
-	MethodBind *mb = static_cast<MethodBind *>(duk_get_pointer_default(ctx, -1, NULL));
-	ERR_FAIL_NULL_V(mb, DUK_NO_RET_VAL);
+	const MethodSignature *signature = static_cast<const MethodSignature *>(duk_get_native_ptr(ctx, -1));
+	ERR_FAIL_NULL_V(signature, DUK_NO_RET_VAL);
+	MethodBind *mb = signature->method;
 
 	duk_push_this(ctx);
 	Object *ptr = duk_get_godot_object(ctx, -1);
 	ERR_FAIL_NULL_V(ptr, DUK_NO_RET_VAL);
 
+	if (signature->ptrcall && argc >= signature->argument_count) {
+		bool handled = false;
+		duk_ret_t ret = duk_ptrcall_godot_method(ctx, ptr, *signature, handled);
+		if (handled) {
+			return ret;
+		}
+	}
+
 	Variant::CallError err;
 
 	if (!mb->is_vararg()) {
 		argc = MIN(argc, mb->get_argument_count());
 	}
 
-	const Variant **args = memnew_arr(const Variant *, argc);
-	Vector<Variant> vargs;
-	vargs.resize(argc);
-	for (duk_idx_t i = 0; i < argc; ++i) {
-		vargs.write[i] = duk_get_godot_variant(ctx, i);
-		args[i] = (vargs.ptr() + i);
-	}
-	Variant ret_val = mb->call(ptr, args, argc, err);
-	if (args != NULL) {
-		memdelete_arr(args);
+	CallArguments args(ctx, argc);
+	Variant ret_val;
+	{
+		HeapUnlock unlock(ctx);
+		ret_val = mb->call(ptr, args.ptr(), args.size(), err);
 	}
 #ifdef DEBUG_METHODS_ENABLED
 	ERR_FAIL_COND_V(err.error != Variant::CallError::CALL_OK, DUK_ERR_TYPE_ERROR);
@@ -318,19 +440,10 @@ duk_ret_t DuktapeBindingHelper::godot_builtin_function(duk_context *ctx) {
 	Variant::CallError err;
 	String err_msg;
 
-	const Variant **args = memnew_arr(const Variant *, argc);
-	Vector<Variant> vargs;
-	vargs.resize(argc);
-	for (duk_idx_t i = 0; i < argc; ++i) {
-		vargs.write[i] = duk_get_godot_variant(ctx, i);
-		args[i] = (vargs.ptr() + i);
-	}
+	CallArguments args(ctx, argc);
 
 	Expression::BuiltinFunc func = (Expression::BuiltinFunc)duk_get_current_magic(ctx);
-	Expression::exec_func(func, args, &ret, err, err_msg);
-	if (args != NULL) {
-		memdelete_arr(args);
-	}
+	Expression::exec_func(func, args.ptr(), &ret, err, err_msg);
 
 	if (err.error != Variant::CallError::CALL_OK) {
 		ERR_EXPLAIN(err_msg);
@@ -347,6 +460,58 @@ duk_ret_t DuktapeBindingHelper::godot_typeof(duk_context *ctx) {
 	return DUK_HAS_RET_VAL;
 }
 
+duk_ret_t DuktapeBindingHelper::godot_as_int(duk_context *ctx) {
+	const double num = duk_to_number(ctx, 0);
+	if (Math::is_nan(num)) {
+		duk_push_int(ctx, 0);
+	} else {
+		duk_push_number_chkfast(ctx, num < 0 ? Math::ceil(num) : Math::floor(num));
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_builtin_payload_stats(duk_context *ctx) {
+	duk_push_godot_variant(ctx, get_singleton()->builtin_payloads.get_stats_dictionary());
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_startup_stats(duk_context *ctx) {
+	const DuktapeBindingHelper *self = get_singleton();
+	Dictionary stats;
+	stats["lazy_class_registration"] = self->lazy_class_registration;
+	stats["initialize_usec"] = self->startup_usec;
+	stats["initialize_memory"] = self->startup_memory;
+	stats["created_classes"] = self->native_class_constructors.size();
+	stats["total_classes"] = ClassDB::classes.size();
+	duk_push_godot_variant(ctx, stats);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_heap_stats(duk_context *ctx) {
+	duk_push_godot_variant(ctx, get_singleton()->heap_accounting.get_stats_dictionary());
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_dump_heap(duk_context *ctx) {
+	get_singleton()->heap_accounting.dump(ctx);
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_ecmascript_stats(duk_context *ctx) {
+	Dictionary stats;
+#ifdef ECMASCRIPT_STATS
+	const BoundaryStats &frame = get_singleton()->last_frame_stats;
+	stats["native_calls"] = frame.native_calls;
+	stats["script_calls"] = frame.script_calls;
+	stats["wrappers_created"] = frame.wrappers_created;
+	stats["wrapper_hits"] = frame.wrapper_hits;
+	stats["container_copies"] = frame.container_copies;
+	stats["payload_allocations"] = frame.payload_allocations;
+#endif
+	duk_push_godot_variant(ctx, stats);
+	return DUK_HAS_RET_VAL;
+}
+
 void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Variant &var) {
 	Variant::Type godot_type = var.get_type();
 	switch (godot_type) {
@@ -357,9 +522,12 @@ void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Varian
 			duk_push_boolean(ctx, duk_bool_t((bool)var));
 			break;
 		case Variant::REAL:
-		case Variant::INT:
 			duk_push_number(ctx, var);
 			break;
+		case Variant::INT:
+			// Stored as fastint in fastint builds so the value comes back as INT
+			duk_push_number_chkfast(ctx, int64_t(var));
+			break;
 		case Variant::STRING:
 		case Variant::NODE_PATH: {
 			duk_push_godot_string(ctx, var);
@@ -368,6 +536,11 @@ void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Varian
 			duk_push_godot_object(ctx, var);
 			break;
 		case Variant::ARRAY: {
+			if (get_singleton()->lazy_container_marshalling) {
+				duk_push_godot_container_proxy(ctx, var);
+				break;
+			}
+			ECMASCRIPT_STATS_INCREMENT(container_copies);
 			const Array &arr = var;
 			duk_push_array(ctx);
 			for (int i = 0; i < arr.size(); ++i) {
@@ -376,6 +549,11 @@ void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Varian
 			}
 		} break;
 		case Variant::DICTIONARY: {
+			if (get_singleton()->lazy_container_marshalling) {
+				duk_push_godot_container_proxy(ctx, var);
+				break;
+			}
+			ECMASCRIPT_STATS_INCREMENT(container_copies);
 			const Dictionary &dict = var;
 			duk_push_object(ctx);
 			for (const Variant *key = dict.next(NULL); key; key = dict.next(key)) {
@@ -388,75 +566,7 @@ void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Varian
 		default: {
 			if (DuktapeHeapObject *prototype = get_singleton()->builtin_class_prototypes.get(godot_type)) {
 				duk_push_object(ctx);
-
-				void *ptr = NULL;
-				switch (godot_type) {
-					case Variant::VECTOR2:
-						ptr = memnew(Vector2(var));
-						break;
-					case Variant::RECT2:
-						ptr = memnew(Rect2(var));
-						break;
-					case Variant::COLOR:
-						ptr = memnew(Color(var));
-						break;
-					case Variant::_RID:
-						ptr = memnew(RID(var));
-						break;
-					case Variant::TRANSFORM2D:
-						ptr = memnew(Transform2D(var));
-						break;
-					case Variant::VECTOR3:
-						ptr = memnew(Vector3(var));
-						break;
-					case Variant::BASIS: {
-						Basis b = var;
-						ptr = memnew(Basis(b.elements[0], b.elements[1], b.elements[2]));
-					} break;
-					case Variant::QUAT: {
-						Quat q = var;
-						ptr = memnew(Quat(q));
-					} break;
-					case Variant::PLANE:
-						ptr = memnew(Plane(var));
-						break;
-					case Variant::AABB:
-						ptr = memnew(AABB(var));
-						break;
-					case Variant::TRANSFORM: {
-						Transform xf;
-						xf = var;
-						ptr = memnew(Transform(xf));
-					} break;
-					case Variant::POOL_BYTE_ARRAY:
-						ptr = memnew(PoolByteArray(var));
-						break;
-					case Variant::POOL_INT_ARRAY:
-						ptr = memnew(PoolIntArray(var));
-						break;
-					case Variant::POOL_REAL_ARRAY:
-						ptr = memnew(PoolRealArray(var));
-						break;
-					case Variant::POOL_STRING_ARRAY:
-						ptr = memnew(PoolByteArray(var));
-						break;
-					case Variant::POOL_VECTOR2_ARRAY:
-						ptr = memnew(PoolVector2Array(var));
-						break;
-					case Variant::POOL_VECTOR3_ARRAY:
-						ptr = memnew(PoolVector3Array(var));
-						break;
-					case Variant::POOL_COLOR_ARRAY:
-						ptr = memnew(PoolColorArray(var));
-						break;
-					default:
-						break;
-				}
-
-				duk_push_pointer(ctx, ptr);
-				duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-				duk_push_int(ctx, godot_type);
-				duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+				duk_set_native_slot(ctx, -1, create_builtin_payload(godot_type, var), godot_type);
 				duk_push_heapptr(ctx, prototype);
 				duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
 			} else {
@@ -467,12 +577,92 @@ void DuktapeBindingHelper::duk_push_godot_variant(duk_context *ctx, const Varian
 	}
 }
 
+void *DuktapeBindingHelper::create_builtin_payload(Variant::Type type, const Variant &var) {
+	DuktapePayloadPool &pool = get_singleton()->builtin_payloads;
+	void *ptr = NULL;
+	switch (type) {
+		case Variant::VECTOR2:
+			ptr = pool.create(type, Vector2(var));
+			break;
+		case Variant::RECT2:
+			ptr = pool.create(type, Rect2(var));
+			break;
+		case Variant::COLOR:
+			ptr = pool.create(type, Color(var));
+			break;
+		case Variant::_RID:
+			ptr = pool.create(type, RID(var));
+			break;
+		case Variant::TRANSFORM2D:
+			ptr = pool.create(type, Transform2D(var));
+			break;
+		case Variant::VECTOR3:
+			ptr = pool.create(type, Vector3(var));
+			break;
+		case Variant::BASIS: {
+			Basis b = var;
+			ptr = pool.create(type, b);
+		} break;
+		case Variant::QUAT: {
+			Quat q = var;
+			ptr = pool.create(type, q);
+		} break;
+		case Variant::PLANE:
+			ptr = pool.create(type, Plane(var));
+			break;
+		case Variant::AABB:
+			ptr = pool.create(type, AABB(var));
+			break;
+		case Variant::TRANSFORM: {
+			Transform xf;
+			xf = var;
+			ptr = pool.create(type, xf);
+		} break;
+		case Variant::POOL_BYTE_ARRAY:
+			ptr = pool.create(type, PoolByteArray(var));
+			break;
+		case Variant::POOL_INT_ARRAY:
+			ptr = pool.create(type, PoolIntArray(var));
+			break;
+		case Variant::POOL_REAL_ARRAY:
+			ptr = pool.create(type, PoolRealArray(var));
+			break;
+		case Variant::POOL_STRING_ARRAY:
+			ptr = pool.create(type, PoolStringArray(var));
+			break;
+		case Variant::POOL_VECTOR2_ARRAY:
+			ptr = pool.create(type, PoolVector2Array(var));
+			break;
+		case Variant::POOL_VECTOR3_ARRAY:
+			ptr = pool.create(type, PoolVector3Array(var));
+			break;
+		case Variant::POOL_COLOR_ARRAY:
+			ptr = pool.create(type, PoolColorArray(var));
+			break;
+		default:
+			break;
+	}
+	return ptr;
+}
+
+void DuktapeBindingHelper::duk_push_builtin_payload(duk_context *ctx, Variant::Type type, void *payload) {
+	duk_push_object(ctx);
+	duk_set_native_slot(ctx, -1, payload, type);
+	duk_push_heapptr(ctx, get_singleton()->builtin_class_prototypes.get(type));
+	duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
+}
+
 Variant DuktapeBindingHelper::duk_get_godot_variant(duk_context *ctx, duk_idx_t idx) {
 	duk_int_t type = duk_get_type(ctx, idx);
 	switch (type) {
 		case DUK_TYPE_BOOLEAN:
 			return Variant(duk_get_boolean(ctx, idx) == true);
 		case DUK_TYPE_NUMBER:
+#ifdef DUK_USE_FASTINT
+			if (duk_is_fastint(ctx, idx)) {
+				return Variant(int64_t(duk_get_number(ctx, idx)));
+			}
+#endif
 			return Variant(duk_get_number(ctx, idx));
 		case DUK_TYPE_STRING: {
 			String str;
@@ -493,10 +683,15 @@ Variant DuktapeBindingHelper::duk_get_godot_variant(duk_context *ctx, duk_idx_t
 					return ref;
 				}
 				return obj;
+			} else if (godot_type == TYPE_POOL_ARRAY_VIEW) {
+				return duk_get_godot_buffer_data(ctx, idx);
 			} else if (godot_type == Variant::NIL) {
 
-				if (duk_is_array(ctx, idx)) { // Array
+				if (duk_is_buffer_data(ctx, idx)) { // ArrayBuffer, TypedArray or DataView
+					return duk_get_godot_buffer_data(ctx, idx);
+				} else if (duk_is_array(ctx, idx)) { // Array
 
+					ECMASCRIPT_STATS_INCREMENT(container_copies);
 					Array arr;
 					duk_size_t len = duk_get_length(ctx, idx);
 					arr.resize(len);
@@ -511,6 +706,7 @@ Variant DuktapeBindingHelper::duk_get_godot_variant(duk_context *ctx, duk_idx_t
 
 				} else { // Dictionary
 
+					ECMASCRIPT_STATS_INCREMENT(container_copies);
 					Dictionary dict;
 
 					duk_enum(ctx, idx, DUK_ENUM_OWN_PROPERTIES_ONLY);
@@ -530,9 +726,7 @@ Variant DuktapeBindingHelper::duk_get_godot_variant(duk_context *ctx, duk_idx_t
 			} else {
 				// builtin types
 				Variant ret;
-				duk_get_prop_literal(ctx, idx, DUK_HIDDEN_SYMBOL("ptr"));
-				DuktapeHeapObject *ptr = duk_get_pointer_default(ctx, -1, NULL);
-				duk_pop(ctx);
+				void *ptr = duk_get_native_ptr(ctx, idx);
 				ERR_FAIL_NULL_V(ptr, ret);
 
 				switch (godot_type) {
@@ -590,12 +784,20 @@ Variant DuktapeBindingHelper::duk_get_godot_variant(duk_context *ctx, duk_idx_t
 					case Variant::POOL_COLOR_ARRAY:
 						ret = *(static_cast<PoolColorArray*>(ptr));
 						break;
+					case Variant::ARRAY: // lazily marshalled containers
+						ret = *(static_cast<Array*>(ptr));
+						break;
+					case Variant::DICTIONARY:
+						ret = *(static_cast<Dictionary*>(ptr));
+						break;
 					default:
 						break;
 				}
 				return ret;
 			}
 		}
+		case DUK_TYPE_BUFFER:
+			return duk_get_godot_buffer_data(ctx, idx);
 		case DUK_TYPE_NULL:
 		case DUK_TYPE_UNDEFINED:
 		default:
@@ -611,36 +813,29 @@ String DuktapeBindingHelper::duk_get_godot_string(duk_context *ctx, duk_idx_t id
 }
 
 Object *DuktapeBindingHelper::duk_get_godot_object(duk_context *ctx, duk_idx_t idx) {
-	duk_get_prop_string(ctx, idx, DUK_HIDDEN_SYMBOL("ptr"));
-	Object *ptr = static_cast<Object *>(duk_get_pointer_default(ctx, -1, NULL));
-	duk_pop(ctx);
-	return ptr;
+	return static_cast<Object *>(duk_get_native_ptr(ctx, idx));
 }
 
 Variant::Type DuktapeBindingHelper::duk_get_godot_variant_type(duk_context *ctx, duk_idx_t idx) {
-	duk_get_prop_string(ctx, idx, DUK_HIDDEN_SYMBOL("type"));
-	Variant::Type type = (Variant::Type)duk_get_int_default(ctx, -1, Variant::NIL);
-	duk_pop(ctx);
-	return type;
+	return (Variant::Type)duk_get_native_tag(ctx, idx, Variant::NIL);
 }
 
 void DuktapeBindingHelper::duk_push_godot_object(duk_context *ctx, Object *obj, bool from_constructor) {
 	if (obj) {
 		DuktapeHeapObject *heap_obj = get_singleton()->get_weak_ref(obj);
 		if (heap_obj) {
+			ECMASCRIPT_STATS_INCREMENT(wrapper_hits);
 			duk_push_heapptr(ctx, heap_obj);
 		} else {
+			ECMASCRIPT_STATS_INCREMENT(wrappers_created);
 			if (from_constructor) {
 				duk_push_this(ctx);
 			} else {
 				duk_push_object(ctx);
-				duk_push_heapptr(ctx, get_singleton()->native_class_prototypes.get(obj->get_class_name()));
+				duk_push_heapptr(ctx, get_singleton()->get_class_prototype(ctx, obj->get_class_name()));
 				duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
 			}
 
-			duk_push_pointer(ctx, obj);
-			duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-
 			int type = Variant::OBJECT;
 
 			heap_obj = duk_get_heapptr(ctx, -1);
@@ -656,8 +851,7 @@ void DuktapeBindingHelper::duk_push_godot_object(duk_context *ctx, Object *obj,
 				get_singleton()->set_strong_ref(obj->get_instance_id(), heap_obj);
 			}
 
-			duk_push_int(ctx, type);
-			duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+			duk_set_native_slot(ctx, -1, obj, type);
 		}
 	} else {
 		duk_push_undefined(ctx);
@@ -672,51 +866,117 @@ void DuktapeBindingHelper::duk_push_godot_string(duk_context *ctx, const String
 	}
 }
 
-void DuktapeBindingHelper::duk_push_godot_string_name(duk_context *ctx, const StringName &str) {
+void DuktapeBindingHelper::duk_push_godot_string_name(duk_context *ctx, const StringName &str, bool p_pin) {
+	if (DuktapeHeapObject **ptr = get_singleton()->string_name_cache.getptr(str)) {
+		duk_push_heapptr(ctx, *ptr);
+		return;
+	}
 	duk_push_godot_string(ctx, str);
+	if (p_pin) {
+		pin_string_name(ctx, str);
+	}
+}
+
+void DuktapeBindingHelper::pin_string_name(duk_context *ctx, const StringName &str) {
+	// The string at the stack top stays reachable from the pool so its heap pointer remains valid
+	DuktapeBindingHelper *self = get_singleton();
+	if (str == StringName()) return;
+
+	DuktapeHeapObject *ptr = duk_get_heapptr(ctx, -1);
+	duk_push_heapptr(ctx, self->string_name_pool_ptr);
+	duk_dup(ctx, -2);
+	duk_put_prop_index(ctx, -2, self->string_name_cache.size());
+	duk_pop(ctx);
+
+	self->string_name_cache.set(str, ptr);
+	self->heap_string_names.set(ptr, str);
+}
+
+StringName DuktapeBindingHelper::duk_get_godot_string_name(duk_context *ctx, duk_idx_t idx, bool p_pin) {
+	if (!duk_is_string(ctx, idx)) {
+		return duk_get_godot_string(ctx, idx, true);
+	}
+
+	const StringName *name = get_singleton()->heap_string_names.getptr(duk_get_heapptr(ctx, idx));
+	if (name) {
+		return *name;
+	}
+
+	StringName ret = duk_get_godot_string(ctx, idx);
+	if (p_pin) {
+		duk_dup(ctx, idx);
+		pin_string_name(ctx, ret);
+		duk_pop(ctx);
+	}
+	return ret;
 }
 
 void DuktapeBindingHelper::duk_put_prop_godot_string(duk_context *ctx, duk_idx_t idx, const String &str) {
 	duk_put_prop_string(ctx, idx, str.utf8().ptr());
 }
 
-void DuktapeBindingHelper::duk_put_prop_godot_string_name(duk_context *ctx, duk_idx_t idx, const StringName &str) {
-	duk_put_prop_godot_string(ctx, idx, str);
+void DuktapeBindingHelper::duk_put_prop_godot_string_name(duk_context *ctx, duk_idx_t idx, const StringName &str, bool p_pin) {
+	idx = duk_normalize_index(ctx, idx);
+	duk_push_godot_string_name(ctx, str, p_pin);
+	duk_insert(ctx, -2);
+	duk_put_prop(ctx, idx);
 }
 
-void DuktapeBindingHelper::register_class(duk_context *ctx, const ClassDB::ClassInfo *cls) {
-	duk_require_stack(ctx, 2);
+void DuktapeBindingHelper::register_class_constants(duk_context *ctx, const ClassDB::ClassInfo *cls) {
+	// constants
+	for (const StringName *const_key = cls->constant_map.next(NULL); const_key; const_key = cls->constant_map.next(const_key)) {
+		duk_push_godot_string_name(ctx, *const_key, true);
+		duk_push_godot_variant(ctx, cls->constant_map.get(*const_key));
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+	}
+	// enumrations
+	for (const StringName *enum_key = cls->enum_map.next(NULL); enum_key; enum_key = cls->enum_map.next(enum_key)) {
+		const List<StringName> &consts = cls->enum_map.get(*enum_key);
+		duk_push_godot_string_name(ctx, *enum_key, true);
+		duk_push_object(ctx);
+		for (const List<StringName>::Element *E = consts.front(); E; E = E->next()) {
+			duk_push_godot_string_name(ctx, E->get(), true);
+			duk_push_godot_variant(ctx, cls->constant_map.get(E->get()));
+			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+		}
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+	}
+}
+
+DuktapeHeapObject *DuktapeBindingHelper::register_class(duk_context *ctx, const ClassDB::ClassInfo *cls) {
+
+	if (DuktapeHeapObject **ptr = native_class_constructors.getptr(cls->name)) {
+		return *ptr;
+	}
+
+	// Base classes come first so the prototype chain is complete as soon as the class exists
+	DuktapeHeapObject *base_prototype_ptr = NULL;
+	DuktapeHeapObject *base_signal_obj = NULL;
+	if (cls->inherits_ptr) {
+		register_class(ctx, cls->inherits_ptr);
+		base_prototype_ptr = native_class_prototypes.get(cls->inherits_ptr->name);
+		base_signal_obj = native_class_signal_objects.get(cls->inherits_ptr->name);
+	}
+
+	duk_require_stack(ctx, 4);
 
-	duk_push_godot_string_name(ctx, cls->name);
 	// Class constuctor function
 	duk_push_c_function(ctx, duk_godot_object_constructor, 0);
+	DuktapeHeapObject *constructor_ptr = duk_get_heapptr(ctx, -1);
 	{
-		// constants
-		for (const StringName *const_key = cls->constant_map.next(NULL); const_key; const_key = cls->constant_map.next(const_key)) {
-			duk_push_godot_string_name(ctx, *const_key);
-			duk_push_godot_variant(ctx, cls->constant_map.get(*const_key));
-			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-		}
-		// enumrations
-		for (const StringName *enum_key = cls->enum_map.next(NULL); enum_key; enum_key = cls->enum_map.next(enum_key)) {
-			const List<StringName> &consts = cls->enum_map.get(*enum_key);
-			duk_push_godot_string_name(ctx, *enum_key);
-			duk_push_object(ctx);
-			for (const List<StringName>::Element *E = consts.front(); E; E = E->next()) {
-				duk_push_godot_string_name(ctx, E->get());
-				duk_push_godot_variant(ctx, cls->constant_map.get(E->get()));
-				duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-			}
-			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-		}
+		register_class_constants(ctx, cls);
 
 		// Class.Signals
 		duk_push_literal(ctx, "Signal");
 		duk_push_object(ctx);
 		DuktapeHeapObject * signal_obj = duk_get_heapptr(ctx, -1);
 		native_class_signal_objects.set(cls->name, signal_obj);
+		if (base_signal_obj) {
+			duk_push_heapptr(ctx, base_signal_obj);
+			duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
+		}
 		for (const StringName *signal_key = cls->signal_map.next(NULL); signal_key; signal_key = cls->signal_map.next(signal_key)) {
-			duk_push_godot_string_name(ctx, *signal_key);
+			duk_push_godot_string_name(ctx, *signal_key, true);
 			duk_dup_top(ctx);
 			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
 		}
@@ -724,6 +984,10 @@ void DuktapeBindingHelper::register_class(duk_context *ctx, const ClassDB::Class
 
 		// Class.prototype
 		duk_push_object(ctx);
+		if (base_prototype_ptr) {
+			duk_push_heapptr(ctx, base_prototype_ptr);
+			duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
+		}
 		// Class.prototype.cls
 		duk_push_pointer(ctx, (void *)cls);
 		duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("cls"));
@@ -736,11 +1000,86 @@ void DuktapeBindingHelper::register_class(duk_context *ctx, const ClassDB::Class
 		duk_put_prop_literal(ctx, -2, "Signal");
 
 		DuktapeHeapObject *proto_ptr = duk_get_heapptr(ctx, -1);
-		get_singleton()->native_class_prototypes[cls->name] = proto_ptr;
+		native_class_prototypes[cls->name] = proto_ptr;
 
 		duk_put_prop_literal(ctx, -2, PROTOTYPE_LITERAL);
 	}
-	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+	// The class may be created for an object before the script reads it from the godot namespace
+	duk_push_heapptr(ctx, native_class_pool_ptr);
+	duk_insert(ctx, -2);
+	duk_put_prop_godot_string_name(ctx, -2, cls->name, true);
+	duk_pop(ctx);
+
+	native_class_constructors.set(cls->name, constructor_ptr);
+	return constructor_ptr;
+}
+
+DuktapeHeapObject *DuktapeBindingHelper::get_class_prototype(duk_context *ctx, const StringName &p_class) {
+	if (DuktapeHeapObject **ptr = native_class_prototypes.getptr(p_class)) {
+		return *ptr;
+	}
+	const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(p_class);
+	ERR_FAIL_NULL_V(cls, NULL);
+	register_class(ctx, cls);
+	return native_class_prototypes.get(p_class);
+}
+
+bool DuktapeBindingHelper::duk_push_godot_singleton(duk_context *ctx, Object *p_singleton) {
+
+	const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(p_singleton->get_class_name());
+	ERR_FAIL_NULL_V(cls, false);
+	DuktapeHeapObject *prototype_ptr = get_class_prototype(ctx, cls->name);
+	ERR_FAIL_NULL_V(prototype_ptr, false);
+
+	duk_push_object(ctx);
+	duk_push_heapptr(ctx, prototype_ptr);
+	duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
+	duk_set_native_slot(ctx, -1, p_singleton, Variant::OBJECT);
+	register_class_constants(ctx, cls);
+	return true;
+}
+
+void DuktapeBindingHelper::duk_push_global_enum(duk_context *ctx, const StringName &p_enum) {
+	duk_push_object(ctx);
+	for (int i = 0; i < GlobalConstants::get_global_constant_count(); ++i) {
+		if (GlobalConstants::get_global_constant_enum(i) != p_enum) continue;
+		duk_push_string(ctx, GlobalConstants::get_global_constant_name(i));
+		duk_push_number(ctx, GlobalConstants::get_global_constant_value(i));
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+	}
+}
+
+duk_ret_t DuktapeBindingHelper::godot_lazy_class_getter(duk_context *ctx) {
+	// Duktape passes the property key to accessors
+	DuktapeBindingHelper *self = get_singleton();
+	const StringName name = duk_get_godot_string_name(ctx, 0);
+
+	switch (duk_get_current_magic(ctx)) {
+		case LAZY_SINGLETON: {
+			Object *singleton = Engine::get_singleton()->get_singleton_object(name);
+			ERR_FAIL_NULL_V(singleton, DUK_ERR_REFERENCE_ERROR);
+			if (!self->duk_push_godot_singleton(ctx, singleton)) {
+				return DUK_ERR_TYPE_ERROR;
+			}
+		} break;
+		case LAZY_GLOBAL_ENUM:
+			duk_push_global_enum(ctx, name);
+			break;
+		default: {
+			const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(name);
+			ERR_FAIL_NULL_V(cls, DUK_ERR_REFERENCE_ERROR);
+			duk_push_heapptr(ctx, self->register_class(ctx, cls));
+		} break;
+	}
+
+	// Replace the accessor by the value so later reads are plain property lookups, it stays enumerable
+	duk_push_this(ctx);
+	duk_dup(ctx, 0);
+	duk_dup(ctx, -3);
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_CLEAR_CONFIGURABLE);
+	duk_pop(ctx);
+	return DUK_HAS_RET_VAL;
 }
 
 DuktapeBindingHelper *DuktapeBindingHelper::get_singleton() {
@@ -753,14 +1092,48 @@ ECMAScriptLanguage *DuktapeBindingHelper::get_language() {
 
 void DuktapeBindingHelper::initialize() {
 
+	const uint64_t start_usec = OS::get_singleton()->get_ticks_usec();
+	const uint64_t start_memory = Memory::get_mem_usage();
+
 	this->ctx = duk_create_heap(alloc_function, realloc_function, free_function, this, fatal_function);
 	ERR_FAIL_NULL(ctx);
+	heap_lock = Mutex::create();
+	heap_lock_depth = 0;
+	thread_context_count = 0;
+#ifdef ECMASCRIPT_STATS
+	memset(&boundary_stats, 0, sizeof(boundary_stats));
+	memset(&last_frame_stats, 0, sizeof(last_frame_stats));
+#endif
+
+	lazy_container_marshalling = GLOBAL_DEF("ecmascript/lazy_container_marshalling", false);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/lazy_container_marshalling", PropertyInfo(Variant::BOOL, "ecmascript/lazy_container_marshalling"));
+	lazy_class_registration = GLOBAL_DEF("ecmascript/lazy_class_registration", true);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/lazy_class_registration", PropertyInfo(Variant::BOOL, "ecmascript/lazy_class_registration"));
+	// in MiB, 0 for no limit
+	const int heap_limit_mb = GLOBAL_DEF("ecmascript/heap_limit_mb", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/heap_limit_mb", PropertyInfo(Variant::INT, "ecmascript/heap_limit_mb", PROPERTY_HINT_RANGE, "0,4096,1"));
+	// Time budgets of script calls in milliseconds, 0 for none. Tool scripts must not hang the editor.
+	const int watchdog_budget_ms = GLOBAL_DEF("ecmascript/watchdog/budget_ms", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/watchdog/budget_ms", PropertyInfo(Variant::INT, "ecmascript/watchdog/budget_ms", PROPERTY_HINT_RANGE, "0,60000,1"));
+	const int watchdog_editor_budget_ms = GLOBAL_DEF("ecmascript/watchdog/editor_budget_ms", 5000);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/watchdog/editor_budget_ms", PropertyInfo(Variant::INT, "ecmascript/watchdog/editor_budget_ms", PROPERTY_HINT_RANGE, "0,60000,1"));
+	watchdog_budget_usec = uint64_t(MAX(Engine::get_singleton()->is_editor_hint() ? watchdog_editor_budget_ms : watchdog_budget_ms, 0)) * 1000;
+	watchdog_deadline_usec = 0;
+	watchdog_depth = 0;
 
 	// strong reference object pool
 	duk_push_heap_stash(ctx);
 	duk_push_object(ctx);
 	this->strongref_pool_ptr = duk_get_heapptr(ctx, -1);
 	duk_put_prop_literal(ctx, -2, "object_pool");
+	// constructors of the godot classes created so far
+	duk_push_object(ctx);
+	this->native_class_pool_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "native_classes");
+	// interned strings of StringNames
+	duk_push_array(ctx);
+	this->string_name_pool_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "string_names");
 	{
 		// pr-edefined functions for godot classes
 		duk_push_c_function(ctx, duk_godot_object_finalizer, 1);
@@ -778,7 +1151,16 @@ void DuktapeBindingHelper::initialize() {
 		duk_push_c_function(ctx, godot_to_string, 0);
 		this->duk_ptr_godot_to_string = duk_get_heapptr(ctx, -1);
 		duk_put_prop_literal(ctx, -2, "godot_object_to_string");
+
+		register_container_proxy_handlers(ctx);
 	}
+	// Duktape threads of other engine threads
+	duk_push_object(ctx);
+	this->thread_context_pool_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "thread_contexts");
+	duk_push_thread(ctx);
+	this->thread_spawner = duk_get_context(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "thread_spawner");
 	duk_pop(ctx);
 
 	// global scope
@@ -802,6 +1184,12 @@ void DuktapeBindingHelper::initialize() {
 	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
 #endif
 
+	// global.require
+	duk_pop(ctx);
+	register_module_loader(ctx);
+	register_event_loop(ctx);
+	duk_push_global_object(ctx);
+
 	// godot namespace
 	duk_push_literal(ctx, "godot");
 	duk_push_object(ctx);
@@ -809,113 +1197,79 @@ void DuktapeBindingHelper::initialize() {
 		// register builtin classes
 		register_builtin_classes(ctx);
 		// register classes
-		const StringName *key = ClassDB::classes.next(NULL);
-		while (key) {
-			const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(*key);
-			register_class(ctx, cls);
-			key = ClassDB::classes.next(key);
-		}
-		// setup proto chain for prototypes and signals
-		key = ClassDB::classes.next(NULL);
-		while (key) {
-			const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(*key);
-			if (cls->inherits_ptr) {
-
-				duk_require_stack(ctx, 2);
-				DuktapeHeapObject *prototype_ptr = native_class_prototypes.get(cls->name);
-				duk_push_heapptr(ctx, prototype_ptr);
-				DuktapeHeapObject *base_prototype_ptr = native_class_prototypes.get(cls->inherits_ptr->name);
-				duk_push_heapptr(ctx, base_prototype_ptr);
-				duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
-				duk_pop(ctx);
-
-				duk_require_stack(ctx, 3);
-				DuktapeHeapObject *signal_obj = native_class_signal_objects.get(cls->name);
-				DuktapeHeapObject *base_signal_obj = native_class_signal_objects.get(cls->inherits_ptr->name);
-				duk_push_heapptr(ctx, signal_obj);
-				duk_push_heapptr(ctx, base_signal_obj);
-				duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
-				duk_pop(ctx);
+		if (lazy_class_registration) {
+			// Classes and singletons are created when they are read from the godot namespace for the first time
+			duk_push_c_function(ctx, godot_lazy_class_getter, 1);
+			duk_set_magic(ctx, -1, LAZY_CLASS);
+			DuktapeHeapObject *class_getter = duk_get_heapptr(ctx, -1);
+			duk_push_c_function(ctx, godot_lazy_class_getter, 1);
+			duk_set_magic(ctx, -1, LAZY_SINGLETON);
+			DuktapeHeapObject *singleton_getter = duk_get_heapptr(ctx, -1);
+
+			for (const StringName *key = ClassDB::classes.next(NULL); key; key = ClassDB::classes.next(key)) {
+				duk_push_godot_string_name(ctx, *key, true);
+				duk_push_heapptr(ctx, class_getter);
+				duk_def_prop(ctx, -5, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_SET_ENUMERABLE | DUK_DEFPROP_SET_CONFIGURABLE);
 			}
-			key = ClassDB::classes.next(key);
-		}
-
-		// Singletons
-		List<Engine::Singleton> singletons;
-		Engine::get_singleton()->get_singletons(&singletons);
-		for (List<Engine::Singleton>::Element *E = singletons.front(); E; E = E->next()) {
-			const Engine::Singleton &s = E->get();
-
-			ERR_CONTINUE(s.ptr == NULL);
 
-			DuktapeHeapObject *prototype_ptr = native_class_prototypes.get(s.ptr->get_class_name());
-			ERR_CONTINUE(prototype_ptr == NULL);
+			List<Engine::Singleton> singletons;
+			Engine::get_singleton()->get_singletons(&singletons);
+			for (List<Engine::Singleton>::Element *E = singletons.front(); E; E = E->next()) {
+				ERR_CONTINUE(E->get().ptr == NULL);
+				duk_push_godot_string_name(ctx, E->get().name, true);
+				duk_push_heapptr(ctx, singleton_getter);
+				duk_def_prop(ctx, -5, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_SET_ENUMERABLE | DUK_DEFPROP_SET_CONFIGURABLE | DUK_DEFPROP_FORCE);
+			}
+			duk_pop_2(ctx);
+		} else {
+			for (const StringName *key = ClassDB::classes.next(NULL); key; key = ClassDB::classes.next(key)) {
+				const ClassDB::ClassInfo *cls = ClassDB::classes.getptr(*key);
+				duk_push_godot_string_name(ctx, cls->name, true);
+				duk_push_heapptr(ctx, register_class(ctx, cls));
+				duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+			}
 
-			duk_push_godot_string_name(ctx, s.name);
-			duk_push_object(ctx);
-			DuktapeHeapObject *cur_singleton_object = duk_get_heapptr(ctx, -1);
-			duk_push_heapptr(ctx, prototype_ptr);
-			duk_put_prop_literal(ctx, -2, PROTO_LITERAL);
-			duk_push_pointer(ctx, s.ptr);
-			duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-			duk_push_int(ctx, Variant::OBJECT);
-			duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
-
-			if (ClassDB::ClassInfo *cls = ClassDB::classes.getptr(s.ptr->get_class_name())) {
-				// constants
-				for (const StringName *const_key = cls->constant_map.next(NULL); const_key; const_key = cls->constant_map.next(const_key)) {
-					duk_push_godot_string_name(ctx, *const_key);
-					duk_push_godot_variant(ctx, cls->constant_map.get(*const_key));
-					duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-				}
-				// enumrations
-				for (const StringName *enum_key = cls->enum_map.next(NULL); enum_key; enum_key = cls->enum_map.next(enum_key)) {
-					const List<StringName> &consts = cls->enum_map.get(*enum_key);
-					duk_push_godot_string_name(ctx, *enum_key);
-					duk_push_object(ctx);
-					for (const List<StringName>::Element *E = consts.front(); E; E = E->next()) {
-						duk_push_godot_string_name(ctx, E->get());
-						duk_push_godot_variant(ctx, cls->constant_map.get(E->get()));
-						duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-					}
-					duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+			// Singletons
+			List<Engine::Singleton> singletons;
+			Engine::get_singleton()->get_singletons(&singletons);
+			for (List<Engine::Singleton>::Element *E = singletons.front(); E; E = E->next()) {
+				const Engine::Singleton &s = E->get();
+				ERR_CONTINUE(s.ptr == NULL);
+
+				duk_push_godot_string_name(ctx, s.name, true);
+				if (duk_push_godot_singleton(ctx, s.ptr)) {
+					duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE | DUK_DEFPROP_FORCE);
+				} else {
+					duk_pop(ctx);
 				}
 			}
-			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE | DUK_DEFPROP_FORCE);
 		}
+
 		// global constants
-		HashMap<StringName, HashMap<StringName, int> > global_constants;
+		Set<StringName> global_enums;
 		for (int i = 0; i < GlobalConstants::get_global_constant_count(); ++i) {
-
-			StringName enum_name = GlobalConstants::get_global_constant_enum(i);
-			const char *const_name = GlobalConstants::get_global_constant_name(i);
-			const int value = GlobalConstants::get_global_constant_value(i);
-
-			duk_push_string(ctx, const_name);
-			duk_push_number(ctx, value);
+			duk_push_string(ctx, GlobalConstants::get_global_constant_name(i));
+			duk_push_number(ctx, GlobalConstants::get_global_constant_value(i));
 			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
-
-			if (HashMap<StringName, int> *consts = global_constants.getptr(enum_name)) {
-				consts->set(const_name, value);
-			} else {
-				HashMap<StringName, int> enum_;
-				enum_.set(const_name, value);
-				global_constants.set(enum_name, enum_);
-			}
+			global_enums.insert(GlobalConstants::get_global_constant_enum(i));
 		}
 
 		// global enums
-		for (const StringName *enum_name = global_constants.next(NULL); enum_name; enum_name = global_constants.next(enum_name)) {
-			duk_push_godot_string_name(ctx, *enum_name);
-			duk_push_object(ctx);
-			const HashMap<StringName, int> &enum_ = global_constants.get(*enum_name);
-			for (const StringName *const_name = enum_.next(NULL); const_name; const_name = enum_.next(const_name)) {
-				duk_push_godot_string_name(ctx, *const_name);
-				const int value = enum_.get(*const_name);
-				duk_push_number(ctx, value);
+		if (lazy_class_registration) {
+			duk_push_c_function(ctx, godot_lazy_class_getter, 1);
+			duk_set_magic(ctx, -1, LAZY_GLOBAL_ENUM);
+			for (Set<StringName>::Element *E = global_enums.front(); E; E = E->next()) {
+				duk_push_godot_string_name(ctx, E->get(), true);
+				duk_dup(ctx, -2);
+				duk_def_prop(ctx, -4, DUK_DEFPROP_HAVE_GETTER | DUK_DEFPROP_SET_ENUMERABLE | DUK_DEFPROP_SET_CONFIGURABLE);
+			}
+			duk_pop(ctx);
+		} else {
+			for (Set<StringName>::Element *E = global_enums.front(); E; E = E->next()) {
+				duk_push_godot_string_name(ctx, E->get(), true);
+				duk_push_global_enum(ctx, E->get());
 				duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
 			}
-			duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
 		}
 
 		// buitin functions
@@ -944,11 +1298,54 @@ void DuktapeBindingHelper::initialize() {
 		duk_push_literal(ctx, "get_type");
 		duk_push_c_function(ctx, godot_typeof, 1);
 		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "as_int");
+		duk_push_c_function(ctx, godot_as_int, 1);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "get_builtin_payload_stats");
+		duk_push_c_function(ctx, godot_builtin_payload_stats, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "get_startup_stats");
+		duk_push_c_function(ctx, godot_startup_stats, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "ecmascript_stats");
+		duk_push_c_function(ctx, godot_ecmascript_stats, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "get_heap_stats");
+		duk_push_c_function(ctx, godot_heap_stats, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "dump_heap");
+		duk_push_c_function(ctx, godot_dump_heap, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "structured_clone");
+		duk_push_c_function(ctx, godot_structured_clone, 2);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "Worker");
+		duk_push_worker_class(ctx);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		register_coroutines(ctx);
 	}
 	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
 
+	// Memory usage is only tracked by debug builds of the engine
+	startup_usec = OS::get_singleton()->get_ticks_usec() - start_usec;
+	startup_memory = Memory::get_mem_usage() - start_memory;
+
+	// Applied after the godot namespace is created, errors can only be handled once scripts run
+	heap_accounting.set_limit(ctx, uint64_t(MAX(heap_limit_mb, 0)) * 1024 * 1024);
+
 #ifdef DEBUG_ENABLED
 	debugger.initialize(ctx);
+	profiler_sample_interval = GLOBAL_DEF("ecmascript/profiler/sample_interval", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/profiler/sample_interval", PropertyInfo(Variant::INT, "ecmascript/profiler/sample_interval", PROPERTY_HINT_RANGE, "100,100000,100"));
 #endif
 }
 
@@ -956,10 +1353,99 @@ void DuktapeBindingHelper::uninitialize() {
 
 #ifdef DEBUG_ENABLED
 	debugger.uninitialize();
+	profiler.stop(ctx);
 #endif
 
+	// Finalizers may allocate
+	heap_accounting.set_limit(NULL, 0);
+	// Worker objects terminate their threads when they are finalized with the heap
 	duk_destroy_heap(ctx);
 	this->ctx = NULL;
+	this->thread_spawner = NULL;
+	thread_contexts.clear();
+	suspended_contexts.clear();
+	memdelete(heap_lock);
+	heap_lock = NULL;
+	for (Set<DuktapeWorker *>::Element *E = workers.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	workers.clear();
+	// coroutines waiting for signals of objects that are still alive
+	const uint32_t *id = coroutine_signals.next(NULL);
+	while (id) {
+		memdelete(coroutine_signals.get(*id));
+		id = coroutine_signals.next(id);
+	}
+	coroutine_signals.clear();
+	coroutine_timers.clear();
+	ready_coroutines.clear();
+	timers.clear();
+	pending_jobs = 0;
+
+	// all builtin payloads are released by the finalizers of the destroyed heap
+	builtin_payloads.clear();
+	native_class_constructors.clear();
+	native_class_prototypes.clear();
+	native_class_signal_objects.clear();
+	string_name_cache.clear();
+	heap_string_names.clear();
+}
+
+void DuktapeBindingHelper::frame() {
+	HeapLock lock(this);
+#ifdef ECMASCRIPT_STATS
+	last_frame_stats = boundary_stats;
+	memset(&boundary_stats, 0, sizeof(boundary_stats));
+#endif
+#ifdef DEBUG_ENABLED
+	if (profiler.is_active()) {
+		profiler.frame();
+	}
+#endif
+	run_jobs(ctx);
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	if (timers.has_due(now)) {
+		run_timers(ctx, now);
+	}
+	if (!ready_coroutines.empty() || !coroutine_timers.empty()) {
+		resume_coroutines();
+	}
+	if (!workers.empty()) {
+		dispatch_worker_messages();
+	}
+	run_jobs(ctx);
+}
+
+void DuktapeBindingHelper::profiling_start() {
+#ifdef DEBUG_ENABLED
+	HeapLock lock(this);
+	profiler.start(ctx, profiler_sample_interval);
+#endif
+}
+
+void DuktapeBindingHelper::profiling_stop() {
+#ifdef DEBUG_ENABLED
+	HeapLock lock(this);
+	profiler.stop(ctx);
+#endif
+}
+
+int DuktapeBindingHelper::profiling_get_accumulated_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) {
+#ifdef DEBUG_ENABLED
+	HeapLock lock(this);
+	return profiler.get_accumulated_data(p_info_arr, p_info_max);
+#else
+	return -1;
+#endif
+}
+
+int DuktapeBindingHelper::profiling_get_frame_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) {
+#ifdef DEBUG_ENABLED
+	HeapLock lock(this);
+	return profiler.get_frame_data(p_info_arr, p_info_max);
+#else
+	return -1;
+#endif
 }
 
 void DuktapeBindingHelper::register_class_members(duk_context *ctx, const ClassDB::ClassInfo *cls) {
@@ -987,7 +1473,7 @@ void DuktapeBindingHelper::register_class_members(duk_context *ctx, const ClassD
 
 			MethodBind *mb = cls->method_map.get(*key);
 			duk_push_godot_method(ctx, mb);
-			duk_put_prop_godot_string_name(ctx, -2, mb->get_name());
+			duk_put_prop_godot_string_name(ctx, -2, mb->get_name(), true);
 
 			key = cls->method_map.next(key);
 		}
@@ -1002,7 +1488,7 @@ void DuktapeBindingHelper::register_class_members(duk_context *ctx, const ClassD
 
 			const ClassDB::PropertySetGet &prop = cls->property_setget[*key];
 			duk_uidx_t masks = DUK_DEFPROP_FORCE;
-			duk_push_godot_string_name(ctx, *key);
+			duk_push_godot_string_name(ctx, *key, true);
 			if (prop._getptr) {
 				duk_push_godot_method(ctx, prop._getptr);
 				masks |= DUK_DEFPROP_HAVE_GETTER;
@@ -1035,9 +1521,10 @@ void DuktapeBindingHelper::duk_push_godot_method(duk_context *ctx, const MethodB
 			heap_ptr = duk_ptr_godot_object_virtual_method;
 		} else {
 			duk_size_t argc = DUK_VARARGS; // (mb->is_vararg() || mb->get_default_argument_count()) ? DUK_VARARGS : mb->get_argument_count();
+			MethodSignature &signature = method_signatures[mb];
+			build_method_signature(mb, signature);
 			duk_push_c_function(ctx, duk_godot_object_method, argc);
-			duk_push_pointer(ctx, (void *)mb);
-			duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("mb"));
+			duk_set_native_slot(ctx, -1, &signature, 0);
 			heap_ptr = duk_get_heapptr(ctx, -1);
 		}
 		method_bindings[mb] = heap_ptr;
@@ -1069,6 +1556,16 @@ duk_ret_t DuktapeBindingHelper::register_ecma_class(duk_context *ctx) {
 
 	// ecmascript methods
 	duk_get_prop_literal(ctx, CLASS_FUNC_IDX, PROTOTYPE_LITERAL);
+	// the class name seen through the parent prototype belongs to the nearest script base class
+	duk_get_prototype(ctx, -1);
+	if (duk_is_object(ctx, -1)) {
+		duk_get_prop_literal(ctx, -1, ECMA_CLASS_NAME_LITERAL);
+		if (duk_is_string(ctx, -1)) {
+			ecma_class.base_class = duk_get_godot_string_name(ctx, -1, true);
+		}
+		duk_pop(ctx);
+	}
+	duk_pop(ctx);
 	// MyClass.prototype.class_name = 'MyClass';
 	duk_push_string(ctx, class_name);
 	duk_put_prop_literal(ctx, -2, ECMA_CLASS_NAME_LITERAL);
@@ -1076,11 +1573,9 @@ duk_ret_t DuktapeBindingHelper::register_ecma_class(duk_context *ctx) {
 	// for (var key in MyClass.prototype)
 	duk_enum(ctx, -1, DUK_HINT_NONE);
 	while (duk_next(ctx, -1, true)) {
-		const char *name = duk_get_string(ctx, -2);
 		if (duk_is_ecmascript_function(ctx, -1)) {
-			StringName method_name = name;
 			ECMAMethodInfo method = { duk_get_heapptr(ctx, -1) };
-			ecma_class.methods.set(name, method);
+			ecma_class.methods.set(duk_get_godot_string_name(ctx, -2, true), method);
 		}
 		duk_pop_2(ctx);
 	}
@@ -1141,15 +1636,12 @@ duk_ret_t DuktapeBindingHelper::register_ecma_class(duk_context *ctx) {
 				}
 				duk_pop(ctx);
 
-				duk_get_prop_literal(ctx, -1, "name");
-				const char *p_name = duk_get_string_default(ctx, -1, NULL);
-				duk_pop(ctx);
-
 				duk_get_prop_literal(ctx, -1, "default");
 				Variant value = duk_get_godot_variant(ctx, -1);
 				duk_pop(ctx);
 
-				ecma_class.properties.set(p_name, { (Variant::Type)p_type, value });
+				// props are keyed by their name, pinned for get_instance_property and set_instance_property
+				ecma_class.properties.set(duk_get_godot_string_name(ctx, -2, true), { (Variant::Type)p_type, value });
 			}
 			duk_pop_2(ctx);
 		}
@@ -1162,13 +1654,19 @@ duk_ret_t DuktapeBindingHelper::register_ecma_class(duk_context *ctx) {
 	duk_push_string(ctx, class_name);
 	duk_put_prop_literal(ctx, -2, ECMA_CLASS_NAME_LITERAL);
 
-	get_singleton()->ecma_classes.set(class_name, ecma_class);
+	ecma_class.virtual_methods = get_virtual_methods(ecma_class.methods);
+	get_singleton()->set_class(class_name, ecma_class);
 
+	// A reloaded class keeps its script so resources and instances using it stay valid
 	Ref<ECMAScript> script;
-	script.instance();
-	script->class_name = class_name;
+	if (Ref<ECMAScript> *existing = get_language()->script_classes.getptr(class_name)) {
+		script = *existing;
+	} else {
+		script.instance();
+		script->class_name = class_name;
+		get_language()->script_classes.set(class_name, script);
+	}
 	script->library = ECMAScriptLibraryResourceLoader::get_loading_library();
-	get_language()->script_classes.set(class_name, script);
 
 	return DUK_HAS_RET_VAL;
 }
@@ -1254,9 +1752,18 @@ ECMAScriptGCHandler DuktapeBindingHelper::create_ecma_instance_for_godot_object(
 	ERR_FAIL_NULL_V(p_object, ret);
 	ERR_FAIL_NULL_V(ecma_class, ret);
 
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
 	duk_push_heapptr(ctx, ecma_class->ecma_constructor.ecma_object);
 	ecma_instance_target = p_object;
-	duk_new(ctx, 0);
+	WatchdogScope watchdog(this);
+	// Errors must not unwind past the heap lock
+	if (DUK_EXEC_SUCCESS != duk_pnew(ctx, 0)) {
+		ecma_instance_target = NULL;
+		duk_print_error(ctx, -1);
+		duk_pop(ctx);
+		return ret;
+	}
 	ecma_instance_target = NULL;
 	ret.ecma_object = duk_get_heapptr(ctx, -1);
 	set_strong_ref(p_object->get_instance_id(), ret.ecma_object);
@@ -1274,13 +1781,35 @@ Variant DuktapeBindingHelper::call_method(const ECMAScriptGCHandler &p_object, c
 		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 		return Variant();
 	}
+
+	ECMASCRIPT_STATS_INCREMENT(script_calls);
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
 	duk_push_heapptr(ctx, p_method.ecma_object);
 	duk_push_heapptr(ctx, p_object.ecma_object);
 
 	for (int i = 0; i < p_argcount; ++i) {
 		duk_push_godot_variant(ctx, *(p_args[i]));
 	}
-	duk_call_method(ctx, p_argcount);
+
+#ifdef DEBUG_ENABLED
+	uint64_t profile_start = 0;
+	const int profile_function = profiler.is_active() ? profiler.begin_call(ctx, -(p_argcount + 2), profile_start) : -1;
+#endif
+	// Errors must not unwind past the heap lock
+	WatchdogScope watchdog(this);
+	const duk_int_t rc = duk_pcall_method(ctx, p_argcount);
+#ifdef DEBUG_ENABLED
+	if (profiler.is_active()) {
+		profiler.end_call(profile_function, profile_start);
+	}
+#endif
+	if (DUK_EXEC_SUCCESS != rc) {
+		duk_print_error(ctx, -1);
+		duk_pop(ctx);
+		r_error.error = Variant::CallError::CALL_OK;
+		return Variant();
+	}
 	Variant ret = duk_get_godot_variant(ctx, -1);
 	duk_pop(ctx);
 
@@ -1288,20 +1817,59 @@ Variant DuktapeBindingHelper::call_method(const ECMAScriptGCHandler &p_object, c
 	return ret;
 }
 
+duk_ret_t DuktapeBindingHelper::safe_get_prop(duk_context *ctx, void *udata) {
+	duk_get_prop(ctx, -2);
+	return 1;
+}
+
+duk_ret_t DuktapeBindingHelper::safe_put_prop(duk_context *ctx, void *udata) {
+	duk_put_prop(ctx, -3);
+	return 0;
+}
+
 bool DuktapeBindingHelper::get_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, Variant &r_ret) {
 	ERR_FAIL_COND_V(p_object.is_null(), false);
-	String name = p_name;
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
 	duk_push_heapptr(ctx, p_object.ecma_object);
-	duk_get_prop_string(ctx, -1, name.utf8().ptr());
+	duk_push_godot_string_name(ctx, p_name);
+	// Getters are script code, their errors must not unwind past the heap lock
+	WatchdogScope watchdog(this);
+	if (DUK_EXEC_SUCCESS != duk_safe_call(ctx, safe_get_prop, NULL, 2, 1)) {
+		duk_print_error(ctx, -1);
+		duk_pop(ctx);
+		return false;
+	}
 	r_ret = duk_get_godot_variant(ctx, -1);
-	return !duk_is_undefined(ctx, -1);
+	const bool valid = !duk_is_undefined(ctx, -1);
+	duk_pop(ctx);
+	return valid;
 }
 
 bool DuktapeBindingHelper::set_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, const Variant &p_value) {
 	ERR_FAIL_COND_V(p_object.is_null(), false);
-	String name = p_name;
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
 	duk_push_heapptr(ctx, p_object.ecma_object);
+	duk_push_godot_string_name(ctx, p_name);
 	duk_push_godot_variant(ctx, p_value);
-	duk_put_prop_string(ctx, -2, name.utf8().ptr());
-	return true;
+	WatchdogScope watchdog(this);
+	const bool failed = DUK_EXEC_SUCCESS != duk_safe_call(ctx, safe_put_prop, NULL, 3, 1);
+	if (failed) {
+		duk_print_error(ctx, -1);
+	}
+	duk_pop(ctx);
+	return !failed;
+}
+
+void DuktapeBindingHelper::rebind_instance(const ECMAScriptGCHandler &p_object, const ECMAClassInfo &p_class) {
+	ERR_FAIL_COND(p_object.is_null() || p_class.ecma_constructor.is_null());
+	HeapLock lock(this);
+	duk_context *ctx = get_thread_context();
+	duk_push_heapptr(ctx, p_object.ecma_object);
+	duk_push_heapptr(ctx, p_class.ecma_constructor.ecma_object);
+	duk_get_prop_literal(ctx, -1, PROTOTYPE_LITERAL);
+	duk_remove(ctx, -2);
+	duk_set_prototype(ctx, -2);
+	duk_pop(ctx);
 }
@@ -4,28 +4,56 @@
 #include "../ecmascript_binding_helper.h"
 #include "core/hash_map.h"
 #include "core/object.h"
+#include "core/os/os.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
 #include "core/reference.h"
+#include "core/safe_refcount.h"
+#include "core/set.h"
 #include "core/string_name.h"
 #include "core/variant.h"
+#include "duktape_heap_accounting.h"
+#include "duktape_payload_pool.h"
+#include "duktape_timer_heap.h"
+#include "duktape_worker.h"
 #include "src/duktape.h"
 
 #ifdef DEBUG_ENABLED
 #include "debugger/duktape_debugger.h"
+#include "duktape_profiler.h"
 #endif
 
 #define DUK_NO_RET_VAL 0
 #define DUK_HAS_RET_VAL 1
 #define TYPE_GODOT_REFERENCE Variant::VARIANT_MAX
+#define TYPE_POOL_ARRAY_VIEW (Variant::VARIANT_MAX + 1)
+
+// Boundary crossing counters, compiled in with ecmascript_stats=yes
+#ifdef ECMASCRIPT_STATS
+#define ECMASCRIPT_STATS_INCREMENT(m_counter) atomic_increment(&DuktapeBindingHelper::get_singleton()->boundary_stats.m_counter)
+#else
+#define ECMASCRIPT_STATS_INCREMENT(m_counter)
+#endif
 
 typedef void DuktapeHeapObject;
 class ECMAScriptLanguage;
+class DuktapeCoroutineSignal;
 
 class DuktapeBindingHelper : public ECMAScriptBindingHelper {
 
 	friend class ECMAScriptLanguage;
+	friend class DuktapeWorker;
+	friend class DuktapeMessage;
+	friend class DuktapeCoroutineSignal;
 
 	duk_context *ctx;
 
+	struct HeapPtrHash {
+		static _FORCE_INLINE_ uint32_t hash(const DuktapeHeapObject *p_ptr) {
+			return HashMapHasherDefault::hash((uint64_t)(uintptr_t)p_ptr);
+		}
+	};
+
 	struct MethodPtrHash {
 		static _FORCE_INLINE_ uint32_t hash(const MethodBind *p_mb) {
 			union {
@@ -37,14 +65,58 @@ class DuktapeBindingHelper : public ECMAScriptBindingHelper {
 		}
 	};
 
+	/**
+	 * The Variant arguments of a native call converted from the Duktape value stack.
+	 * Up to STACK_CAPACITY arguments live inside the object so common calls don't touch the heap,
+	 * longer argument lists fall back to a heap allocation.
+	 */
+	class CallArguments {
+		enum {
+			STACK_CAPACITY = 8,
+		};
+
+		uint64_t stack_values[(STACK_CAPACITY * sizeof(Variant) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+		const Variant *stack_ptrs[STACK_CAPACITY];
+		Variant *values;
+		const Variant **ptrs;
+		int count;
+
+	public:
+		_FORCE_INLINE_ const Variant **ptr() const { return ptrs; }
+		_FORCE_INLINE_ int size() const { return count; }
+
+		_FORCE_INLINE_ CallArguments(duk_context *ctx, int p_count) {
+			count = p_count;
+			if (count <= STACK_CAPACITY) {
+				values = reinterpret_cast<Variant *>(stack_values);
+				ptrs = stack_ptrs;
+			} else {
+				values = static_cast<Variant *>(memalloc(sizeof(Variant) * count));
+				ptrs = static_cast<const Variant **>(memalloc(sizeof(const Variant *) * count));
+			}
+			for (int i = 0; i < count; ++i) {
+				memnew_placement(values + i, Variant(duk_get_godot_variant(ctx, i)));
+				ptrs[i] = values + i;
+			}
+		}
+
+		_FORCE_INLINE_ ~CallArguments() {
+			for (int i = 0; i < count; ++i) {
+				values[i].~Variant();
+			}
+			if (count > STACK_CAPACITY) {
+				memfree(values);
+				memfree(ptrs);
+			}
+		}
+	};
+
 private:
 	static Object *ecma_instance_target;
-	// memery managerment functions
-	_FORCE_INLINE_ static void *alloc_function(void *udata, duk_size_t size) { return memalloc(size); }
-	_FORCE_INLINE_ static void *realloc_function(void *udata, void *ptr, duk_size_t size) { return memrealloc(ptr, size); }
-	_FORCE_INLINE_ static void free_function(void *udata, void *ptr) {
-		if (ptr) memfree(ptr);
-	}
+	// memery managerment functions, counted by heap_accounting
+	_FORCE_INLINE_ static void *alloc_function(void *udata, duk_size_t size) { return static_cast<DuktapeBindingHelper *>(udata)->heap_accounting.alloc(size); }
+	_FORCE_INLINE_ static void *realloc_function(void *udata, void *ptr, duk_size_t size) { return static_cast<DuktapeBindingHelper *>(udata)->heap_accounting.realloc(ptr, size); }
+	_FORCE_INLINE_ static void free_function(void *udata, void *ptr) { static_cast<DuktapeBindingHelper *>(udata)->heap_accounting.free(ptr); }
 
 	// handle duktape fatal errors
 	static void fatal_function(void *udata, const char *msg);
@@ -59,42 +131,223 @@ private:
 	static duk_ret_t godot_to_string(duk_context *ctx);
 	static duk_ret_t godot_builtin_function(duk_context *ctx);
 	static duk_ret_t godot_typeof(duk_context *ctx);
+	static duk_ret_t godot_as_int(duk_context *ctx);
+	static duk_ret_t godot_builtin_payload_stats(duk_context *ctx);
+	static duk_ret_t godot_startup_stats(duk_context *ctx);
+	static duk_ret_t godot_ecmascript_stats(duk_context *ctx);
+	static duk_ret_t godot_heap_stats(duk_context *ctx);
+	static duk_ret_t godot_dump_heap(duk_context *ctx);
 
 	static duk_ret_t console_log_function(duk_context *ctx);
 	static duk_ret_t console_warn_function(duk_context *ctx);
 	static duk_ret_t console_error_function(duk_context *ctx);
 
+	// Prints an error value with the script stack when it has one
+	static void duk_print_error(duk_context *ctx, duk_idx_t idx);
 	static void duk_push_godot_variant(duk_context *ctx, const Variant &var);
+	static void duk_push_godot_container_proxy(duk_context *ctx, const Variant &var);
+	static void *create_builtin_payload(Variant::Type type, const Variant &var);
+	static void duk_push_builtin_payload(duk_context *ctx, Variant::Type type, void *payload);
 	static void duk_push_godot_object(duk_context *ctx, Object *obj, bool from_constructor = false);
 	static void duk_push_godot_string(duk_context *ctx, const String &str);
-	static void duk_push_godot_string_name(duk_context *ctx, const StringName &str);
+	// Names of classes, methods, properties and the like are pinned when registered, other names are only looked up
+	static void duk_push_godot_string_name(duk_context *ctx, const StringName &str, bool p_pin = false);
 
 	static void duk_put_prop_godot_string(duk_context *ctx, duk_idx_t idx, const String &str);
-	static void duk_put_prop_godot_string_name(duk_context *ctx, duk_idx_t idx, const StringName &str);
+	static void duk_put_prop_godot_string_name(duk_context *ctx, duk_idx_t idx, const StringName &str, bool p_pin = false);
 
+	static StringName duk_get_godot_string_name(duk_context *ctx, duk_idx_t idx, bool p_pin = false);
+	static void pin_string_name(duk_context *ctx, const StringName &str);
 	static Variant duk_get_godot_variant(duk_context *ctx, duk_idx_t idx);
+	static Variant duk_get_godot_buffer_data(duk_context *ctx, duk_idx_t idx);
+
+	// TypedArray views of pool arrays, usable in every heap that registered the view finalizer
+	static DuktapeHeapObject *register_pool_array_view_finalizer(duk_context *ctx);
+	static duk_uint_t get_pool_array_view_type(Variant::Type p_type);
+	static void duk_push_pool_array_view(duk_context *ctx, Variant &r_array);
+	static Variant duk_detach_pool_array_view(duk_context *ctx, duk_idx_t idx);
 	static String duk_get_godot_string(duk_context *ctx, duk_idx_t idx, bool convert_type = false);
 	static Object *duk_get_godot_object(duk_context *ctx, duk_idx_t idx);
 	static Variant::Type duk_get_godot_variant_type(duk_context *ctx, duk_idx_t idx);
 
-	void register_class(duk_context *ctx, const ClassDB::ClassInfo *cls);
+	// Creates the constructor of a godot class and its base classes, returns the existing one if already created
+	DuktapeHeapObject *register_class(duk_context *ctx, const ClassDB::ClassInfo *cls);
+	DuktapeHeapObject *get_class_prototype(duk_context *ctx, const StringName &p_class);
+	bool duk_push_godot_singleton(duk_context *ctx, Object *p_singleton);
+	static void register_class_constants(duk_context *ctx, const ClassDB::ClassInfo *cls);
+	static void duk_push_global_enum(duk_context *ctx, const StringName &p_enum);
+	enum {
+		LAZY_CLASS,
+		LAZY_SINGLETON,
+		LAZY_GLOBAL_ENUM,
+	};
+	static duk_ret_t godot_lazy_class_getter(duk_context *ctx);
 	void register_builtin_classes(duk_context *ctx);
+	void register_container_proxy_handlers(duk_context *ctx);
+
+	// Proxy traps of lazily marshalled Array and Dictionary
+	static duk_ret_t container_proxy_finalizer(duk_context *ctx);
+	static duk_ret_t array_proxy_get(duk_context *ctx);
+	static duk_ret_t array_proxy_set(duk_context *ctx);
+	static duk_ret_t array_proxy_has(duk_context *ctx);
+	static duk_ret_t array_proxy_delete(duk_context *ctx);
+	static duk_ret_t array_proxy_own_keys(duk_context *ctx);
+	static duk_ret_t dictionary_proxy_get(duk_context *ctx);
+	static duk_ret_t dictionary_proxy_set(duk_context *ctx);
+	static duk_ret_t dictionary_proxy_has(duk_context *ctx);
+	static duk_ret_t dictionary_proxy_delete(duk_context *ctx);
+	static duk_ret_t dictionary_proxy_own_keys(duk_context *ctx);
+
+	// CommonJS modules
+	static duk_ret_t godot_require(duk_context *ctx);
+	static bool require_module(duk_context *ctx);
+	static String resolve_module_path(const String &p_dirname, const String &p_id);
+	static void duk_push_require_function(duk_context *ctx, const String &p_dirname);
+	static bool duk_push_module_function(duk_context *ctx, const String &p_path);
+	static String wrap_module_source(const String &p_source);
+	// Runs the module function at the stack top as the module of p_path, replaces it with the exports or the error
+	static bool duk_call_module_function(duk_context *ctx, const String &p_path);
+	static duk_ret_t safe_load_function(duk_context *ctx, void *udata);
+	static duk_ret_t safe_get_prop(duk_context *ctx, void *udata);
+	static duk_ret_t safe_put_prop(duk_context *ctx, void *udata);
+	void register_module_loader(duk_context *ctx);
+
+	// godot.Worker
+	static DuktapeWorker *create_worker(duk_context *ctx, const String &p_path);
+	static DuktapeWorker *duk_get_worker(duk_context *ctx, duk_idx_t idx);
+	static bool post_worker_message(duk_context *ctx);
+	static bool structured_clone(duk_context *ctx);
+	static duk_ret_t godot_structured_clone(duk_context *ctx);
+	static duk_ret_t godot_worker_constructor(duk_context *ctx);
+	static duk_ret_t godot_worker_post_message(duk_context *ctx);
+	static duk_ret_t godot_worker_terminate(duk_context *ctx);
+	static duk_ret_t godot_worker_finalizer(duk_context *ctx);
+	static void duk_push_worker_class(duk_context *ctx);
+	void dispatch_worker_messages();
+
+	// godot.start_coroutine
+	enum CoroutineWait {
+		COROUTINE_WAIT_SIGNAL,
+		COROUTINE_WAIT_SECONDS,
+		COROUTINE_WAIT_FRAME,
+	};
+	struct CoroutineResume {
+		uint32_t id;
+		Variant value;
+	};
+	static bool check_coroutine_wait(duk_context *ctx);
+	static duk_ret_t godot_check_coroutine_wait(duk_context *ctx);
+	static duk_ret_t godot_start_coroutine(duk_context *ctx);
+	void register_coroutines(duk_context *ctx);
+	void resume_coroutine(duk_context *ctx, uint32_t p_id, const Variant &p_value);
+	bool wait_coroutine(duk_context *ctx, uint32_t p_id);
+	void signal_coroutine(DuktapeCoroutineSignal *p_receiver, const Variant **p_args, int p_argcount);
+	void resume_coroutines();
+
+	// Promise, setTimeout and setInterval
+	static duk_ret_t godot_enqueue_job(duk_context *ctx);
+	static duk_ret_t godot_unhandled_rejection(duk_context *ctx);
+	static duk_ret_t godot_set_timer(duk_context *ctx);
+	static duk_ret_t godot_clear_timer(duk_context *ctx);
+	void register_event_loop(duk_context *ctx);
+	void run_jobs(duk_context *ctx);
+	void run_timers(duk_context *ctx, uint64_t p_now_usec);
 
 private:
 	HashMap<Variant::Type, DuktapeHeapObject *> builtin_class_prototypes;
 	HashMap<Variant::Type, DuktapeHeapObject *> builtin_class_constructors;
+	HashMap<StringName, DuktapeHeapObject *> native_class_constructors;
 	HashMap<StringName, DuktapeHeapObject *> native_class_prototypes;
 	HashMap<StringName, DuktapeHeapObject *> native_class_signal_objects;
 	HashMap<const MethodBind *, DuktapeHeapObject *, MethodPtrHash> method_bindings;
 
+	/**
+	 * Precomputed argument layout of a MethodBind, the native slot of a method function points to it.
+	 * Methods taking and returning only primitives and builtin value types are dispatched through ptrcall.
+	 */
+	struct MethodSignature {
+		enum {
+			MAX_PTRCALL_ARGS = 8,
+		};
+		MethodBind *method;
+		bool ptrcall;
+		bool has_return;
+		Variant::Type return_type;
+		int argument_count;
+		Variant::Type argument_types[MAX_PTRCALL_ARGS];
+	};
+	HashMap<const MethodBind *, MethodSignature, MethodPtrHash> method_signatures;
+
 	HashMap<ObjectID, DuktapeHeapObject *> weakref_pool;
 
+	// native storage of builtin value wrappers
+	DuktapePayloadPool builtin_payloads;
+	// memory of the main heap
+	DuktapeHeapAccounting heap_accounting;
+
+	// push Array and Dictionary as Proxy objects instead of deep copies
+	bool lazy_container_marshalling;
+	// create godot classes on first access instead of at initialization
+	bool lazy_class_registration;
+	DuktapeHeapObject *native_class_pool_ptr;
+	DuktapeHeapObject *module_registry_ptr;
+	uint64_t startup_usec;
+	uint64_t startup_memory;
+
+	// Registered StringNames and their interned Duktape strings, pinned by the string_names array in the heap stash
+	DuktapeHeapObject *string_name_pool_ptr;
+	HashMap<StringName, DuktapeHeapObject *> string_name_cache;
+	HashMap<const DuktapeHeapObject *, StringName, HeapPtrHash> heap_string_names;
+
+	// running workers, deleted by the finalizer of their Worker object
+	Set<DuktapeWorker *> workers;
+
+	/**
+	 * Suspended coroutines are Duktape threads kept in the coroutines object of the heap stash. Nothing is done
+	 * for them per frame: signals queue them in ready_coroutines when they fire and timers are only checked at
+	 * the top of the heap.
+	 */
+	DuktapeHeapObject *coroutine_pool_ptr;
+	DuktapeHeapObject *coroutine_resume_ptr;
+	DuktapeHeapObject *coroutine_wait_ptr; // marks the wait requests yielded by the coroutines
+	uint32_t last_coroutine_id;
+	DuktapeTimerHeap coroutine_timers;
+	Vector<CoroutineResume> ready_coroutines; // signals may fire on any thread, only used with heap_lock held
+	HashMap<uint32_t, DuktapeCoroutineSignal *> coroutine_signals;
+
+	// Promise reactions waiting in the jobs array of the heap stash, run until none is left
+	DuktapeHeapObject *job_queue_ptr;
+	uint32_t pending_jobs;
+	// callbacks of setTimeout and setInterval in the timers object of the heap stash
+	DuktapeHeapObject *timer_pool_ptr;
+	uint32_t last_timer_id;
+	DuktapeTimerHeap timers;
+
 	DuktapeHeapObject *strongref_pool_ptr;
 	HashMap<ObjectID, DuktapeHeapObject *> strongref_pool;
 
+#ifdef ECMASCRIPT_STATS
+	/**
+	 * Crossings between scripts and the engine, counted atomically as worker heaps count too.
+	 * frame() publishes the counts of the finished frame in last_frame_stats.
+	 */
+	struct BoundaryStats {
+		uint32_t native_calls; // engine methods called by scripts
+		uint32_t script_calls; // script methods called by the engine
+		uint32_t wrappers_created;
+		uint32_t wrapper_hits; // objects pushed with their existing wrapper
+		uint32_t container_copies; // Array and Dictionary deep copies, both ways
+		uint32_t payload_allocations;
+	};
+	BoundaryStats boundary_stats;
+	BoundaryStats last_frame_stats;
+#endif
+
 	// for register godot classes
 	void register_class_members(duk_context *ctx, const ClassDB::ClassInfo *cls);
 	void duk_push_godot_method(duk_context *ctx, const MethodBind *mb);
+	static void build_method_signature(const MethodBind *mb, MethodSignature &r_signature);
+	static duk_ret_t duk_ptrcall_godot_method(duk_context *ctx, Object *obj, const MethodSignature &signature, bool &r_handled);
 
 	// weak references
 	DuktapeHeapObject *get_weak_ref(Object *obj);
@@ -128,15 +381,110 @@ private:
 	DuktapeHeapObject *duk_ptr_godot_object_free;
 	DuktapeHeapObject *duk_ptr_godot_to_string;
 	DuktapeHeapObject *duk_ptr_godot_object_virtual_method;
+	DuktapeHeapObject *duk_ptr_container_proxy_finalizer;
+	DuktapeHeapObject *duk_ptr_array_proxy_handler;
+	DuktapeHeapObject *duk_ptr_dictionary_proxy_handler;
 
 #ifdef DEBUG_ENABLED
 	DuktapeDebugger debugger;
+	DuktapeProfiler profiler;
+	int profiler_sample_interval; // executed instructions between two samples
 #endif
 
+	/**
+	 * Engine threads other than the main thread run scripts in their own Duktape thread of the main heap, so they
+	 * share the globals and the registered classes. The heap runs one native thread at a time: engine entry points
+	 * hold heap_lock and calls to native methods release it, so a script waiting for a thread that calls back into
+	 * scripts doesn't deadlock.
+	 */
+	Mutex *heap_lock;
+	int heap_lock_depth; // only changed by the thread holding heap_lock
+	uint32_t thread_context_count; // atomic, lets threads that never ran scripts exit without the lock
+	duk_context *thread_spawner; // creates the thread contexts, only used with heap_lock held
+	DuktapeHeapObject *thread_context_pool_ptr;
+	HashMap<Thread::ID, duk_context *> thread_contexts;
+
+	// A suspended context stays running, scripts called back during the native call run on nested contexts
+	struct SuspendedContexts {
+		int depth;
+		Vector<duk_context *> nested;
+
+		SuspendedContexts() :
+				depth(0) {}
+	};
+	HashMap<Thread::ID, SuspendedContexts> suspended_contexts;
+
+	duk_context *get_thread_context();
+	void release_nested_contexts(Thread::ID p_id);
+
+	// Objects may still ask for their binding data after the heap is gone
+	class HeapLock {
+		DuktapeBindingHelper *helper;
+
+	public:
+		_FORCE_INLINE_ HeapLock(DuktapeBindingHelper *p_helper) :
+				helper(p_helper->heap_lock ? p_helper : NULL) {
+			if (helper) {
+				helper->heap_lock->lock();
+				++helper->heap_lock_depth;
+			}
+		}
+		_FORCE_INLINE_ ~HeapLock() {
+			if (helper) {
+				--helper->heap_lock_depth;
+				helper->heap_lock->unlock();
+			}
+		}
+	};
+
+	/**
+	 * Execution watchdog. The outermost script call from the engine must return within watchdog_budget_usec,
+	 * Duktape asks exec_timeout_check every DUK_HTHREAD_INTCTR_DEFAULT instructions and throws a RangeError
+	 * with the script stack once the deadline passed. Time spent in native methods isn't counted.
+	 */
+	uint64_t watchdog_budget_usec; // 0 disables the watchdog
+	uint64_t watchdog_deadline_usec; // 0 while no call is timed
+	int watchdog_depth; // only changed by the thread holding heap_lock
+
+	class WatchdogScope {
+		DuktapeBindingHelper *helper;
+
+	public:
+		_FORCE_INLINE_ WatchdogScope(DuktapeBindingHelper *p_helper) :
+				helper(p_helper) {
+			if (helper->watchdog_depth++ == 0 && helper->watchdog_budget_usec) {
+				helper->watchdog_deadline_usec = OS::get_singleton()->get_ticks_usec() + helper->watchdog_budget_usec;
+			}
+		}
+		_FORCE_INLINE_ ~WatchdogScope() {
+			if (--helper->watchdog_depth == 0) {
+				helper->watchdog_deadline_usec = 0;
+			}
+		}
+	};
+
+	// Suspends ctx and releases the heap to other threads during a native call, the watchdog of the call is paused
+	class HeapUnlock {
+		duk_context *ctx;
+		duk_thread_state state;
+		SuspendedContexts *suspended;
+		int depth;
+		int watchdog_depth;
+		uint64_t watchdog_deadline_usec;
+		uint64_t unlock_usec;
+
+	public:
+		HeapUnlock(duk_context *p_ctx);
+		~HeapUnlock();
+	};
+
 public:
 	_FORCE_INLINE_ duk_context *get_context() { return this->ctx; }
+	_FORCE_INLINE_ const DuktapePayloadPool &get_builtin_payloads() const { return builtin_payloads; }
 	static DuktapeBindingHelper *get_singleton();
 	static ECMAScriptLanguage *get_language();
+	// DUK_USE_EXEC_TIMEOUT_CHECK of every heap
+	static bool exec_timeout_check(void *udata);
 
 	virtual void initialize();
 	virtual void uninitialize();
@@ -149,11 +497,25 @@ public:
 
 	virtual Error eval_string(const String &p_source);
 	virtual Error safe_eval_text(const String &p_source, String &r_error);
+	virtual uint32_t get_bytecode_version() const;
+	virtual Error compile_to_bytecode(const String &p_source, const String &p_path, Vector<uint8_t> &r_bytecode);
+	virtual Error eval_bytecode(const Vector<uint8_t> &p_bytecode);
 
 	virtual ECMAScriptGCHandler create_ecma_instance_for_godot_object(const StringName &ecma_class_name, Object *p_object);
 	virtual Variant call_method(const ECMAScriptGCHandler &p_object, const ECMAMethodInfo &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 	virtual bool get_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, Variant &r_ret);
 	virtual bool set_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, const Variant &p_value);
+	virtual void rebind_instance(const ECMAScriptGCHandler &p_object, const ECMAClassInfo &p_class);
+	virtual void clear_classes();
+	virtual void frame();
+	virtual void thread_enter();
+	virtual void thread_exit();
+	virtual void lock();
+	virtual void unlock();
+	virtual void profiling_start();
+	virtual void profiling_stop();
+	virtual int profiling_get_accumulated_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max);
+	virtual int profiling_get_frame_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max);
 };
 
 #endif
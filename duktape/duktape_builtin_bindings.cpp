@@ -7,6 +7,8 @@ HashMap<Variant::Type, DuktapeHeapObject *> *class_constructors = NULL;
 Variant (*duk_get_variant)(duk_context *ctx, duk_idx_t idx) = NULL;
 void (*duk_push_variant)(duk_context *ctx, const Variant &var) = NULL;
 DuktapeHeapObject *godot_to_string_ptr = NULL;
+DuktapePayloadPool *builtin_payload_pool = NULL;
+static DuktapeHeapObject *pool_array_view_finalizer_ptr = NULL;
 
 duk_ret_t vector2_constructor(duk_context *ctx);
 void vector2_properties(duk_context *ctx);
@@ -45,8 +47,10 @@ void DuktapeBindingHelper::register_builtin_classes(duk_context *ctx) {
 	class_prototypes = &builtin_class_prototypes;
 	class_constructors = &builtin_class_constructors;
 	godot_to_string_ptr = duk_ptr_godot_to_string;
+	builtin_payload_pool = &builtin_payloads;
 	duk_get_variant = duk_get_godot_variant;
 	duk_push_variant = duk_push_godot_variant;
+	pool_array_view_finalizer_ptr = register_pool_array_view_finalizer(ctx);
 
 	// register builtin classes
 	register_builtin_class<Vector2>(ctx, vector2_constructor, 2, Variant::VECTOR2, "Vector2");
@@ -97,18 +101,15 @@ duk_ret_t vector2_constructor(duk_context *ctx) {
 	Vector2 *ptr = NULL;
 	if (duk_is_object(ctx, 0)) {
 		Vector2 v = duk_get_variant(ctx, 0);
-		ptr = memnew(Vector2(v));
+		ptr = builtin_payload_pool->create(Variant::VECTOR2, Vector2(v));
 	} else {
 		duk_double_t x = duk_get_number_default(ctx, 0, 0);
 		duk_double_t y = duk_get_number_default(ctx, 1, 0);
-		ptr = memnew(Vector2(x, y));
+		ptr = builtin_payload_pool->create(Variant::VECTOR2, Vector2(x, y));
 	}
 
 	duk_push_this(ctx);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::VECTOR2);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::VECTOR2);
 
 	return DUK_NO_RET_VAL;
 }
@@ -210,19 +211,16 @@ duk_ret_t vector3_constructor(duk_context *ctx) {
 	Vector3 *ptr = NULL;
 	if (duk_is_object(ctx, 0)) {
 		Vector3 v = duk_get_variant(ctx, 0);
-		ptr = memnew(Vector3(v));
+		ptr = builtin_payload_pool->create(Variant::VECTOR3, Vector3(v));
 	} else {
 		duk_double_t x = duk_get_number_default(ctx, 0, 0);
 		duk_double_t y = duk_get_number_default(ctx, 1, 0);
 		duk_double_t z = duk_get_number_default(ctx, 2, 0);
-		ptr = memnew(Vector3(x, y, z));
+		ptr = builtin_payload_pool->create(Variant::VECTOR3, Vector3(x, y, z));
 	}
 
 	duk_push_this(ctx);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::VECTOR3);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::VECTOR3);
 
 	return DUK_NO_RET_VAL;
 }
@@ -335,28 +333,25 @@ duk_ret_t rect2_constructor(duk_context *ctx) {
 			real_t y = duk_get_number_default(ctx, 1, 0);
 			real_t w = duk_get_number_default(ctx, 2, 0);
 			real_t h = duk_get_number_default(ctx, 3, 0);
-			ptr = memnew(Rect2(x, y, w, h));
+			ptr = builtin_payload_pool->create(Variant::RECT2, Rect2(x, y, w, h));
 		} break;
 		case Variant::VECTOR2: {
 			Vector2 pos = arg0;
 			Vector2 size = duk_get_variant(ctx, 1);
-			ptr = memnew(Rect2(pos, size));
+			ptr = builtin_payload_pool->create(Variant::RECT2, Rect2(pos, size));
 		} break;
 		case Variant::RECT2: {
 			Rect2 r = arg0;
-			ptr = memnew(Rect2(r));
+			ptr = builtin_payload_pool->create(Variant::RECT2, Rect2(r));
 		} break;
 		default:
-			ptr = memnew(Rect2());
+			ptr = builtin_payload_pool->create(Variant::RECT2, Rect2());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
 	duk_push_this(ctx);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::RECT2);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::RECT2);
 
 	return DUK_NO_RET_VAL;
 }
@@ -392,24 +387,21 @@ duk_ret_t color_constructor(duk_context *ctx) {
 	Color *ptr = NULL;
 
 	if (duk_is_string(ctx, 0)) {
-		ptr = memnew(Color(Color::html(duk_get_string(ctx, 0))));
+		ptr = builtin_payload_pool->create(Variant::COLOR, Color(Color::html(duk_get_string(ctx, 0))));
 	} else if (duk_is_undefined(ctx, 1) && duk_is_number(ctx, 0)) {
-		ptr = memnew(Color(Color::hex(duk_get_uint(ctx, 0))));
+		ptr = builtin_payload_pool->create(Variant::COLOR, Color(Color::hex(duk_get_uint(ctx, 0))));
 	} else if (duk_is_object(ctx, 0)) {
 		Color c = duk_get_variant(ctx, 0);
-		ptr = memnew(Color(c));
+		ptr = builtin_payload_pool->create(Variant::COLOR, Color(c));
 	} else {
 		duk_double_t r = duk_get_number_default(ctx, 0, 0);
 		duk_double_t g = duk_get_number_default(ctx, 1, 0);
 		duk_double_t b = duk_get_number_default(ctx, 2, 0);
 		duk_double_t a = duk_get_number_default(ctx, 3, 1);
-		ptr = memnew(Color(r, g, b, a));
+		ptr = builtin_payload_pool->create(Variant::COLOR, Color(r, g, b, a));
 	}
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::COLOR);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::COLOR);
 
 	return DUK_NO_RET_VAL;
 }
@@ -632,19 +624,16 @@ duk_ret_t rid_constructor(duk_context *ctx) {
 	Variant from = duk_get_variant(ctx, 0);
 	if (from.get_type() == Variant::_RID) {
 		RID rid = from;
-		ptr = memnew(RID(rid));
+		ptr = builtin_payload_pool->create(Variant::_RID, RID(rid));
 	} else {
 		Object * obj = from;
 		if(Resource * res = Object::cast_to<Resource>(obj)) {
-			ptr = memnew(RID(res->get_rid()));
+			ptr = builtin_payload_pool->create(Variant::_RID, RID(res->get_rid()));
 		}
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::_RID);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::_RID);
 
 	return DUK_NO_RET_VAL;
 }
@@ -664,29 +653,26 @@ duk_ret_t transform2d_constructor(duk_context *ctx) {
 		case Variant::VECTOR2: {
 				Vector2 arg1 = duk_get_variant(ctx, 1);
 				Vector2 arg2 = duk_get_variant(ctx, 2);
-				ptr = memnew(Transform2D());
+				ptr = builtin_payload_pool->create(Variant::TRANSFORM2D, Transform2D());
 				ptr->elements[0] = arg0;
 				ptr->elements[1] = arg1;
 				ptr->elements[2] = arg2;
 			} break;
 		case Variant::REAL: {
 			Vector2 arg1 = duk_get_variant(ctx, 1);
-			ptr = memnew(Transform2D(arg0, arg1));
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM2D, Transform2D(arg0, arg1));
 		} break;
 		case Variant::TRANSFORM2D: {
 			Transform2D xf = arg0;
-			ptr = memnew(Transform2D(xf));
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM2D, Transform2D(xf));
 		} break;
 		default:
-			ptr = memnew(Transform2D());
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM2D, Transform2D());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::TRANSFORM2D);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::TRANSFORM2D);
 
 	return DUK_NO_RET_VAL;
 }
@@ -793,33 +779,30 @@ duk_ret_t basis_constructor(duk_context *ctx) {
 	switch (arg0.get_type()) {
 		case Variant::QUAT: {
 			Quat q = arg0;
-			ptr = memnew(Basis(q));
+			ptr = builtin_payload_pool->create(Variant::BASIS, Basis(q));
 		} break;
 		case Variant::VECTOR3: {
 			Vector3 p1 = arg0;
 			Variant arg1 = duk_get_variant(ctx, 1);
 			if (arg1.get_type() == Variant::REAL) {
-				ptr = memnew(Basis(p1, real_t(arg1)));
+				ptr = builtin_payload_pool->create(Variant::BASIS, Basis(p1, real_t(arg1)));
 			} else {
 				Vector3 p2 = arg1;
 				Vector3 p3 = duk_get_variant(ctx, 2);
-				ptr = memnew(Basis(p1, p2, p3));
+				ptr = builtin_payload_pool->create(Variant::BASIS, Basis(p1, p2, p3));
 			}
 		} break;
 		case Variant::BASIS: {
 			Basis b = arg0;
-			ptr = memnew(Basis(b));
+			ptr = builtin_payload_pool->create(Variant::BASIS, Basis(b));
 		} break;
 		default:
-			ptr = memnew(Basis);
+			ptr = builtin_payload_pool->create(Variant::BASIS, Basis());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::BASIS);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::BASIS);
 	return DUK_NO_RET_VAL;
 }
 
@@ -940,15 +923,15 @@ duk_ret_t quat_constructor(duk_context *ctx) {
 	switch (arg0.get_type()) {
 		case Variant::BASIS: {
 			Basis b = arg0;
-			ptr = memnew(Quat(b));
+			ptr = builtin_payload_pool->create(Variant::QUAT, Quat(b));
 		} break;
 		case Variant::VECTOR3: {
 			Vector3 p1 = arg0;
 			Variant arg1 = duk_get_variant(ctx, 1);
 			if (arg1.get_type() == Variant::REAL) {
-				ptr = memnew(Quat(p1, real_t(arg1)));
+				ptr = builtin_payload_pool->create(Variant::QUAT, Quat(p1, real_t(arg1)));
 			} else {
-				ptr = memnew(Quat(p1));
+				ptr = builtin_payload_pool->create(Variant::QUAT, Quat(p1));
 			}
 		} break;
 		case Variant::REAL: {
@@ -956,22 +939,19 @@ duk_ret_t quat_constructor(duk_context *ctx) {
 			real_t y = duk_get_number_default(ctx, 1, 0);
 			real_t z = duk_get_number_default(ctx, 2, 0);
 			real_t w = duk_get_number_default(ctx, 3, 0);
-			ptr = memnew(Quat(x, y, z, w));
+			ptr = builtin_payload_pool->create(Variant::QUAT, Quat(x, y, z, w));
 		} break;
 		case Variant::QUAT: {
 			Quat q = arg0;
-			ptr = memnew(Quat(q));
+			ptr = builtin_payload_pool->create(Variant::QUAT, Quat(q));
 		} break;
 		default:
-			ptr = memnew(Quat);
+			ptr = builtin_payload_pool->create(Variant::QUAT, Quat());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::BASIS);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::QUAT);
 	return DUK_NO_RET_VAL;
 
 }
@@ -1074,11 +1054,11 @@ duk_ret_t plane_constructor(duk_context *ctx) {
 			Vector3 p1 = arg0;
 			Variant arg1 = duk_get_variant(ctx, 1);
 			if (arg1.get_type() == Variant::REAL) {
-				ptr = memnew(Plane(p1, real_t(arg1)));
+				ptr = builtin_payload_pool->create(Variant::PLANE, Plane(p1, real_t(arg1)));
 			} else {
 				Vector3 p2 = arg1;
 				Vector3 p3 = duk_get_variant(ctx, 2);
-				ptr = memnew(Plane(p1, p2, p3));
+				ptr = builtin_payload_pool->create(Variant::PLANE, Plane(p1, p2, p3));
 			}
 		} break;
 		case Variant::REAL: {
@@ -1086,22 +1066,19 @@ duk_ret_t plane_constructor(duk_context *ctx) {
 			real_t y = duk_get_number_default(ctx, 1, 0);
 			real_t z = duk_get_number_default(ctx, 2, 0);
 			real_t d = duk_get_number_default(ctx, 3, 0);
-			ptr = memnew(Plane(x, y, z, d));
+			ptr = builtin_payload_pool->create(Variant::PLANE, Plane(x, y, z, d));
 		} break;
 		case Variant::PLANE: {
 			Plane p = arg0;
-			ptr = memnew(Plane(p));
+			ptr = builtin_payload_pool->create(Variant::PLANE, Plane(p));
 		} break;
 		default:
-			ptr = memnew(Plane);
+			ptr = builtin_payload_pool->create(Variant::PLANE, Plane());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::PLANE);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::PLANE);
 	return DUK_NO_RET_VAL;
 }
 
@@ -1228,22 +1205,19 @@ duk_ret_t aabb_constructor(duk_context *ctx) {
 		case Variant::VECTOR3: {
 			Vector3 p1 = arg0;
 			Vector3 p2 = duk_get_variant(ctx, 1);
-			ptr = memnew(AABB(p1, p2));
+			ptr = builtin_payload_pool->create(Variant::AABB, AABB(p1, p2));
 		} break;
 		case Variant::AABB: {
 			AABB p = arg0;
-			ptr = memnew(AABB(p));
+			ptr = builtin_payload_pool->create(Variant::AABB, AABB(p));
 		} break;
 		default:
-			ptr = memnew(AABB);
+			ptr = builtin_payload_pool->create(Variant::AABB, AABB());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::AABB);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::AABB);
 	return DUK_NO_RET_VAL;
 }
 
@@ -1284,41 +1258,38 @@ duk_ret_t transform_constructor(duk_context *ctx) {
 			b.elements[1] = duk_get_variant(ctx, 1);
 			b.elements[2] = duk_get_variant(ctx, 2);
 			Vector3 origin = duk_get_variant(ctx, 3);
-			ptr = memnew(Transform(b, origin));
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(b, origin));
 		} break;
 		case Variant::BASIS: {
 			Basis p1 = arg0;
 			Variant p2 = duk_get_variant(ctx, 1);
 			if (p2.get_type() == Variant::VECTOR3) {
 				Vector3 arg2 = p2;
-				ptr = memnew(Transform(p1, arg2));
+				ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(p1, arg2));
 			} else {
-				ptr = memnew(Transform(p1));
+				ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(p1));
 			}
 		} break;
 		case Variant::QUAT: {
 			Quat p1 = arg0;
-			ptr = memnew(Transform(p1));
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(p1));
 		} break;
 		case Variant::TRANSFORM2D: {
 			Transform2D p1 = arg0;
 			// TODO: construct from Transform2D
-//			ptr = memnew(Transform(p1));
+//			ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(p1));
 		} break;
 		case Variant::TRANSFORM: {
 			Transform p = arg0;
-			ptr = memnew(Transform(p));
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform(p));
 		} break;
 		default:
-			ptr = memnew(Transform);
+			ptr = builtin_payload_pool->create(Variant::TRANSFORM, Transform());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
 
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::TRANSFORM);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::TRANSFORM);
 	return DUK_NO_RET_VAL;
 }
 
@@ -1417,17 +1388,14 @@ duk_ret_t pool_byte_array_constructor(duk_context *ctx) {
 		} break;
 		case Variant::POOL_BYTE_ARRAY: {
 			PoolByteArray p = arg0;
-			ptr = memnew(PoolByteArray(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_BYTE_ARRAY, PoolByteArray(p));
 		} break;
 		default:
-			ptr = memnew(PoolByteArray);
+			ptr = builtin_payload_pool->create(Variant::POOL_BYTE_ARRAY, PoolByteArray());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_BYTE_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_BYTE_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1443,19 +1411,18 @@ duk_ret_t pool_int_array_constructor(duk_context *ctx) {
 		case Variant::ARRAY: {
 			// TODO: constuct from array
 		} break;
+		case Variant::POOL_BYTE_ARRAY:
+		case Variant::POOL_REAL_ARRAY: // converted from typed arrays of another element type
 		case Variant::POOL_INT_ARRAY: {
 			PoolIntArray p = arg0;
-			ptr = memnew(PoolIntArray(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_INT_ARRAY, PoolIntArray(p));
 		} break;
 		default:
-			ptr = memnew(PoolIntArray);
+			ptr = builtin_payload_pool->create(Variant::POOL_INT_ARRAY, PoolIntArray());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_INT_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_INT_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1471,19 +1438,18 @@ duk_ret_t pool_real_array_constructor(duk_context *ctx) {
 		case Variant::ARRAY: {
 			// TODO: constuct from array
 		} break;
+		case Variant::POOL_BYTE_ARRAY:
+		case Variant::POOL_INT_ARRAY: // converted from typed arrays of another element type
 		case Variant::POOL_REAL_ARRAY: {
 			PoolRealArray p = arg0;
-			ptr = memnew(PoolRealArray(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_REAL_ARRAY, PoolRealArray(p));
 		} break;
 		default:
-			ptr = memnew(PoolRealArray);
+			ptr = builtin_payload_pool->create(Variant::POOL_REAL_ARRAY, PoolRealArray());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_REAL_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_REAL_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1501,17 +1467,14 @@ duk_ret_t pool_string_array_constructor(duk_context *ctx) {
 		} break;
 		case Variant::POOL_STRING_ARRAY: {
 			PoolStringArray p = arg0;
-			ptr = memnew(PoolStringArray(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_STRING_ARRAY, PoolStringArray(p));
 		} break;
 		default:
-			ptr = memnew(PoolStringArray);
+			ptr = builtin_payload_pool->create(Variant::POOL_STRING_ARRAY, PoolStringArray());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_STRING_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_STRING_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1529,17 +1492,14 @@ duk_ret_t pool_vector2_array_constructor(duk_context *ctx) {
 		} break;
 		case Variant::POOL_VECTOR2_ARRAY: {
 			PoolVector2Array p = arg0;
-			ptr = memnew(PoolVector2Array(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_VECTOR2_ARRAY, PoolVector2Array(p));
 		} break;
 		default:
-			ptr = memnew(PoolVector2Array);
+			ptr = builtin_payload_pool->create(Variant::POOL_VECTOR2_ARRAY, PoolVector2Array());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_VECTOR2_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_VECTOR2_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1557,17 +1517,14 @@ duk_ret_t pool_vector3_array_constructor(duk_context *ctx) {
 		} break;
 		case Variant::POOL_VECTOR3_ARRAY: {
 			PoolVector3Array p = arg0;
-			ptr = memnew(PoolVector3Array(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_VECTOR3_ARRAY, PoolVector3Array(p));
 		} break;
 		default:
-			ptr = memnew(PoolVector3Array);
+			ptr = builtin_payload_pool->create(Variant::POOL_VECTOR3_ARRAY, PoolVector3Array());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_VECTOR3_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_VECTOR3_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1586,17 +1543,14 @@ duk_ret_t pool_color_array_constructor(duk_context *ctx) {
 		} break;
 		case Variant::POOL_COLOR_ARRAY: {
 			PoolColorArray p = arg0;
-			ptr = memnew(PoolColorArray(p));
+			ptr = builtin_payload_pool->create(Variant::POOL_COLOR_ARRAY, PoolColorArray(p));
 		} break;
 		default:
-			ptr = memnew(PoolColorArray);
+			ptr = builtin_payload_pool->create(Variant::POOL_COLOR_ARRAY, PoolColorArray());
 			break;
 	}
 	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
-	duk_push_pointer(ctx, ptr);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("ptr"));
-	duk_push_int(ctx, Variant::POOL_COLOR_ARRAY);
-	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("type"));
+	duk_set_native_slot(ctx, -1, ptr, Variant::POOL_COLOR_ARRAY);
 
 	return DUK_NO_RET_VAL;
 }
@@ -1612,12 +1566,251 @@ duk_ret_t pool_array_index_getter(duk_context* ctx) {
 	return DUK_HAS_RET_VAL;
 };
 
+#ifdef REAL_T_IS_DOUBLE
+#define DUK_BUFOBJ_REAL_ARRAY DUK_BUFOBJ_FLOAT64ARRAY
+#else
+#define DUK_BUFOBJ_REAL_ARRAY DUK_BUFOBJ_FLOAT32ARRAY
+#endif
+
+/**
+ * Keeps the storage of a pool array referenced and write locked while TypedArray views expose it to scripts.
+ * The holder belongs to the ArrayBuffer behind the views and is released by its finalizer.
+ */
+struct PoolArrayViewHolder {
+	// The storage stays locked for the views, a PoolVector sharing it could not be resized
+	virtual Variant copy_array() const = 0;
+	virtual const void *get_data() const = 0;
+	virtual duk_size_t get_byte_length() const = 0;
+	// Unlocks the storage and hands the pool array over, the holder is empty afterwards
+	virtual Variant detach() = 0;
+	virtual ~PoolArrayViewHolder() {}
+};
+
+template <class T>
+struct PoolArrayViewHolderT : public PoolArrayViewHolder {
+	T array;
+	typename T::Write write;
+
+	virtual Variant copy_array() const {
+		T ret;
+		if (array.size() > 0) {
+			ret.resize(array.size());
+			copymem(ret.write().ptr(), write.ptr(), get_byte_length());
+		}
+		return ret;
+	}
+	virtual const void *get_data() const { return write.ptr(); }
+	virtual duk_size_t get_byte_length() const { return array.size() * sizeof(*write.ptr()); }
+	virtual Variant detach() {
+		write = typename T::Write();
+		Variant ret = array;
+		array = T();
+		return ret;
+	}
+
+	// Takes the reference of r_array so the storage is only copied when something else still shares it
+	PoolArrayViewHolderT(T &r_array) :
+			array(r_array) {
+		r_array = T();
+		write = array.write();
+	}
+};
+
+duk_ret_t pool_array_view_finalizer(duk_context *ctx) {
+	if (duk_get_native_tag(ctx, 0, Variant::NIL) == TYPE_POOL_ARRAY_VIEW) {
+		PoolArrayViewHolder *holder = static_cast<PoolArrayViewHolder *>(duk_get_native_ptr(ctx, 0));
+		duk_set_native_slot(ctx, 0, NULL, Variant::NIL);
+		if (holder) {
+			memdelete(holder);
+		}
+	}
+	return DUK_NO_RET_VAL;
+}
+
+static void duk_push_pool_array_view_holder(duk_context *ctx, PoolArrayViewHolder *holder, duk_uint_t view_type, DuktapeHeapObject *finalizer) {
+	const duk_size_t byte_length = holder->get_byte_length();
+	duk_push_external_buffer(ctx);
+	duk_config_buffer(ctx, -1, const_cast<void *>(holder->get_data()), byte_length);
+
+	// The ArrayBuffer owns the holder, views and their subarrays keep it alive by their .buffer reference
+	duk_push_buffer_object(ctx, -1, 0, byte_length, DUK_BUFOBJ_ARRAYBUFFER);
+	duk_set_native_slot(ctx, -1, holder, TYPE_POOL_ARRAY_VIEW);
+	duk_push_heapptr(ctx, finalizer);
+	duk_set_finalizer(ctx, -2);
+	// Kept to detach the storage when the pool array is transferred
+	duk_dup(ctx, -2);
+	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("data"));
+
+	duk_push_buffer_object(ctx, -1, 0, byte_length, view_type);
+	duk_set_native_slot(ctx, -1, holder, TYPE_POOL_ARRAY_VIEW);
+	duk_remove(ctx, -2);
+	duk_remove(ctx, -2);
+}
+
+/**
+ * PoolXXXArray.prototype.as_typed_array = function() {}
+ * Returns a TypedArray viewing the memory of the pool array. The storage is moved to the view, the pool array is left empty.
+ */
+template <class T>
+duk_ret_t pool_array_as_typed_array(duk_context *ctx) {
+	duk_push_this(ctx);
+	T *ptr = duk_get_builtin_ptr<T>(ctx, -1);
+	ERR_FAIL_NULL_V(ptr, DUK_ERR_TYPE_ERROR);
+
+	// A pool array sharing the locked storage could neither be resized nor written without copying
+	PoolArrayViewHolderT<T> *holder = memnew(PoolArrayViewHolderT<T>(*ptr));
+
+	duk_push_pool_array_view_holder(ctx, holder, duk_get_current_magic(ctx), pool_array_view_finalizer_ptr);
+	return DUK_HAS_RET_VAL;
+}
+
+template <class T>
+static PoolArrayViewHolder *create_pool_array_view_holder(Variant &r_array) {
+	// Drop the reference of the Variant first so the storage is not copied when it is locked for writing
+	T array = r_array;
+	r_array = Variant();
+	return memnew(PoolArrayViewHolderT<T>(array));
+}
+
+duk_uint_t DuktapeBindingHelper::get_pool_array_view_type(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::POOL_BYTE_ARRAY:
+			return DUK_BUFOBJ_UINT8ARRAY;
+		case Variant::POOL_INT_ARRAY:
+			return DUK_BUFOBJ_INT32ARRAY;
+		case Variant::POOL_REAL_ARRAY:
+		case Variant::POOL_VECTOR2_ARRAY:
+		case Variant::POOL_VECTOR3_ARRAY:
+			return DUK_BUFOBJ_REAL_ARRAY;
+		case Variant::POOL_COLOR_ARRAY:
+			return DUK_BUFOBJ_FLOAT32ARRAY;
+		default:
+			return DUK_BUFOBJ_UINT8ARRAY;
+	}
+}
+
+DuktapeHeapObject *DuktapeBindingHelper::register_pool_array_view_finalizer(duk_context *ctx) {
+	duk_push_heap_stash(ctx);
+	duk_push_c_function(ctx, pool_array_view_finalizer, 1);
+	DuktapeHeapObject *ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "pool_array_view_finalizer");
+	duk_pop(ctx);
+	return ptr;
+}
+
+void DuktapeBindingHelper::duk_push_pool_array_view(duk_context *ctx, Variant &r_array) {
+
+	PoolArrayViewHolder *holder = NULL;
+	const Variant::Type type = r_array.get_type();
+	switch (type) {
+		case Variant::POOL_BYTE_ARRAY:
+			holder = create_pool_array_view_holder<PoolByteArray>(r_array);
+			break;
+		case Variant::POOL_INT_ARRAY:
+			holder = create_pool_array_view_holder<PoolIntArray>(r_array);
+			break;
+		case Variant::POOL_REAL_ARRAY:
+			holder = create_pool_array_view_holder<PoolRealArray>(r_array);
+			break;
+		case Variant::POOL_VECTOR2_ARRAY:
+			holder = create_pool_array_view_holder<PoolVector2Array>(r_array);
+			break;
+		case Variant::POOL_VECTOR3_ARRAY:
+			holder = create_pool_array_view_holder<PoolVector3Array>(r_array);
+			break;
+		case Variant::POOL_COLOR_ARRAY:
+			holder = create_pool_array_view_holder<PoolColorArray>(r_array);
+			break;
+		default:
+			duk_push_null(ctx);
+			return;
+	}
+
+	duk_push_heap_stash(ctx);
+	duk_get_prop_literal(ctx, -1, "pool_array_view_finalizer");
+	DuktapeHeapObject *finalizer = duk_get_heapptr(ctx, -1);
+	duk_pop_2(ctx);
+	duk_push_pool_array_view_holder(ctx, holder, get_pool_array_view_type(type), finalizer);
+}
+
+Variant DuktapeBindingHelper::duk_detach_pool_array_view(duk_context *ctx, duk_idx_t idx) {
+	idx = duk_normalize_index(ctx, idx);
+	PoolArrayViewHolder *holder = static_cast<PoolArrayViewHolder *>(duk_get_native_ptr(ctx, idx));
+	if (NULL == holder || duk_get_native_tag(ctx, idx, Variant::NIL) != TYPE_POOL_ARRAY_VIEW) {
+		return Variant();
+	}
+
+	// Views read the storage through the buffer of their ArrayBuffer, emptying it detaches all of them
+	if (duk_get_buffer_object_type(ctx, idx) == DUK_BUFOBJ_ARRAYBUFFER) {
+		duk_dup(ctx, idx);
+	} else {
+		duk_get_prop_literal(ctx, idx, "buffer");
+	}
+	duk_get_prop_literal(ctx, -1, DUK_HIDDEN_SYMBOL("data"));
+	if (duk_is_buffer(ctx, -1)) {
+		duk_config_buffer(ctx, -1, NULL, 0);
+	}
+	duk_pop_2(ctx);
+
+	return holder->detach();
+}
+
+template <class T, class E>
+static T pool_array_from_buffer(const uint8_t *p_data, duk_size_t p_byte_length) {
+	T ret;
+	const int count = p_byte_length / sizeof(E);
+	ret.resize(count);
+	typename T::Write w = ret.write();
+	const E *src = reinterpret_cast<const E *>(p_data);
+	for (int i = 0; i < count; ++i) {
+		w[i] = src[i];
+	}
+	return ret;
+}
+
+Variant DuktapeBindingHelper::duk_get_godot_buffer_data(duk_context *ctx, duk_idx_t idx) {
+
+	duk_size_t byte_length = 0;
+	const uint8_t *data = static_cast<const uint8_t *>(duk_get_buffer_data(ctx, idx, &byte_length));
+
+	// Views returned by as_typed_array are copied to the type of the pool array they expose
+	if (duk_get_native_tag(ctx, idx, Variant::NIL) == TYPE_POOL_ARRAY_VIEW) {
+		if (const PoolArrayViewHolder *holder = static_cast<const PoolArrayViewHolder *>(duk_get_native_ptr(ctx, idx))) {
+			if (holder->get_data() == data && holder->get_byte_length() == byte_length) {
+				return holder->copy_array();
+			}
+		}
+	}
+
+	// Other buffers are copied in bulk by their element type
+	switch (duk_get_buffer_object_type(ctx, idx)) {
+		case DUK_BUFOBJ_INT8ARRAY:
+			return pool_array_from_buffer<PoolIntArray, int8_t>(data, byte_length);
+		case DUK_BUFOBJ_INT16ARRAY:
+			return pool_array_from_buffer<PoolIntArray, int16_t>(data, byte_length);
+		case DUK_BUFOBJ_UINT16ARRAY:
+			return pool_array_from_buffer<PoolIntArray, uint16_t>(data, byte_length);
+		case DUK_BUFOBJ_INT32ARRAY:
+		case DUK_BUFOBJ_UINT32ARRAY:
+			return pool_array_from_buffer<PoolIntArray, int32_t>(data, byte_length);
+		case DUK_BUFOBJ_FLOAT32ARRAY:
+			return pool_array_from_buffer<PoolRealArray, float>(data, byte_length);
+		case DUK_BUFOBJ_FLOAT64ARRAY:
+			return pool_array_from_buffer<PoolRealArray, double>(data, byte_length);
+		default:
+			return pool_array_from_buffer<PoolByteArray, uint8_t>(data, byte_length);
+	}
+}
+
 void pool_array_properties(duk_context *ctx) {
 
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_BYTE_ARRAY));
 
 	duk_push_c_function(ctx, pool_array_index_getter<PoolByteArray>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolByteArray>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_UINT8ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 
 	duk_push_c_function(ctx, ([](duk_context *ctx) -> duk_ret_t{
 							duk_push_this(ctx);
@@ -1703,11 +1896,17 @@ void pool_array_properties(duk_context *ctx) {
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_INT_ARRAY));
 	duk_push_c_function(ctx, pool_array_index_getter<PoolIntArray>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolIntArray>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_INT32ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 	duk_pop(ctx);
 
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_REAL_ARRAY));
 	duk_push_c_function(ctx, pool_array_index_getter<PoolRealArray>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolRealArray>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_REAL_ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 	duk_pop(ctx);
 
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_STRING_ARRAY));
@@ -1718,15 +1917,24 @@ void pool_array_properties(duk_context *ctx) {
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_VECTOR2_ARRAY));
 	duk_push_c_function(ctx, pool_array_index_getter<PoolVector2Array>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolVector2Array>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_REAL_ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 	duk_pop(ctx);
 
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_VECTOR3_ARRAY));
 	duk_push_c_function(ctx, pool_array_index_getter<PoolVector3Array>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolVector3Array>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_REAL_ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 	duk_pop(ctx);
 
 	duk_push_heapptr(ctx, class_prototypes->get(Variant::POOL_COLOR_ARRAY));
 	duk_push_c_function(ctx, pool_array_index_getter<PoolColorArray>, 1);
 	duk_put_prop_literal(ctx, -2, "get");
+	duk_push_c_function(ctx, pool_array_as_typed_array<PoolColorArray>, 0);
+	duk_set_magic(ctx, -1, DUK_BUFOBJ_FLOAT32ARRAY);
+	duk_put_prop_literal(ctx, -2, "as_typed_array");
 	duk_pop(ctx);
 }
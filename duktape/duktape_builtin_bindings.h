@@ -11,21 +11,20 @@ extern HashMap<Variant::Type, DuktapeHeapObject *> *class_constructors;
 extern Variant (*duk_get_variant)(duk_context *ctx, duk_idx_t idx);
 extern void (*duk_push_variant)(duk_context *ctx, const Variant &var);
 extern DuktapeHeapObject *godot_to_string_ptr;
+extern DuktapePayloadPool *builtin_payload_pool;
 
 template<class T>
-T* duk_get_builtin_ptr(duk_context *ctx, duk_idx_t idx) {
-	duk_get_prop_string(ctx,idx, DUK_HIDDEN_SYMBOL("ptr"));
-	T *ptr = static_cast<T *>(duk_get_pointer_default(ctx, -1, NULL));
-	duk_pop(ctx);
-	return ptr;
+_FORCE_INLINE_ T* duk_get_builtin_ptr(duk_context *ctx, duk_idx_t idx) {
+	return static_cast<T *>(duk_get_native_ptr(ctx, idx));
 }
 
 template<class T>
 duk_ret_t builtin_finalizer(duk_context *ctx) {
-	duk_get_prop_string(ctx, -1, DUK_HIDDEN_SYMBOL("ptr"));
-	T *ptr = static_cast<T *>(duk_get_pointer(ctx, -1));
+	T *ptr = duk_get_builtin_ptr<T>(ctx, -1);
 	if (ptr) {
-		memdelete(ptr);
+		Variant::Type type = (Variant::Type)duk_get_native_tag(ctx, -1, Variant::NIL);
+		duk_set_native_slot(ctx, -1, NULL, type);
+		builtin_payload_pool->destroy(type, ptr);
 	}
 	return DUK_NO_RET_VAL;
 }
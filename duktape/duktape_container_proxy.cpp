@@ -0,0 +1,327 @@
+#include "duktape_binding_helper.h"
+
+/**
+ * Lazy marshalling of Array and Dictionary.
+ *
+ * With `ecmascript/lazy_container_marshalling` enabled, Godot containers are pushed as Proxy objects reading and
+ * writing the underlying container on access instead of being deep-copied into ECMAScript arrays and objects.
+ * The proxy target is an empty Array (or Object) holding the container in its native slot and releasing it in its
+ * finalizer. The proxy carries the same slot so a proxy passed back to the engine yields the original container.
+ *
+ * Own properties of the container are never stored on the target. The only exception are the placeholder keys
+ * the ownKeys trap puts on it, Duktape checks the enumerability of the reported keys on the target object.
+ */
+
+template <class T>
+static _FORCE_INLINE_ T *duk_get_container(duk_context *ctx) {
+	return static_cast<T *>(duk_get_native_ptr(ctx, 0));
+}
+
+static bool duk_get_container_index(duk_context *ctx, duk_idx_t idx, int &r_index) {
+	if (duk_is_number(ctx, idx)) {
+		const double num = duk_get_number(ctx, idx);
+		r_index = int(num);
+		return num >= 0 && double(r_index) == num;
+	} else if (duk_is_string(ctx, idx) && !duk_is_symbol(ctx, idx)) {
+		const char *str = duk_get_string(ctx, idx);
+		if (*str < '0' || *str > '9' || (*str == '0' && str[1] != '\0')) {
+			return false;
+		}
+		int64_t num = 0;
+		for (; *str; ++str) {
+			if (*str < '0' || *str > '9') return false;
+			num = num * 10 + (*str - '0');
+			if (num > 0x7FFFFFFF) return false;
+		}
+		r_index = int(num);
+		return true;
+	}
+	return false;
+}
+
+static _FORCE_INLINE_ bool duk_is_length_key(duk_context *ctx, duk_idx_t idx) {
+	return duk_is_string(ctx, idx) && strcmp(duk_get_string(ctx, idx), "length") == 0;
+}
+
+// Finds the key of the dictionary the ECMAScript property key refers to, integer keys are accessed by their string form
+static bool duk_get_dictionary_key(duk_context *ctx, duk_idx_t idx, const Dictionary &dict, Variant &r_key) {
+	String key;
+	key.parse_utf8(duk_to_string(ctx, idx));
+	r_key = key;
+	if (dict.has(key)) {
+		return true;
+	} else if (key.is_valid_integer()) {
+		Variant int_key = key.to_int();
+		if (dict.has(int_key)) {
+			r_key = int_key;
+			return true;
+		}
+	}
+	return false;
+}
+
+void DuktapeBindingHelper::duk_push_godot_container_proxy(duk_context *ctx, const Variant &var) {
+
+	DuktapeBindingHelper *self = get_singleton();
+	const Variant::Type type = var.get_type();
+
+	void *ptr = NULL;
+	if (type == Variant::ARRAY) {
+		duk_push_array(ctx);
+		ptr = self->builtin_payloads.create(type, Array(var));
+	} else {
+		duk_push_object(ctx);
+		ptr = self->builtin_payloads.create(type, Dictionary(var));
+	}
+	duk_set_native_slot(ctx, -1, ptr, type);
+	duk_push_heapptr(ctx, self->duk_ptr_container_proxy_finalizer);
+	duk_set_finalizer(ctx, -2);
+
+	duk_push_heapptr(ctx, type == Variant::ARRAY ? self->duk_ptr_array_proxy_handler : self->duk_ptr_dictionary_proxy_handler);
+	duk_push_proxy(ctx, 0);
+	duk_set_native_slot(ctx, -1, ptr, type);
+}
+
+duk_ret_t DuktapeBindingHelper::container_proxy_finalizer(duk_context *ctx) {
+	void *ptr = duk_get_native_ptr(ctx, 0);
+	if (NULL == ptr) return DUK_NO_RET_VAL;
+
+	const Variant::Type type = duk_get_godot_variant_type(ctx, 0);
+	duk_set_native_slot(ctx, 0, NULL, type);
+	if (type == Variant::ARRAY) {
+		get_singleton()->builtin_payloads.destroy(type, static_cast<Array *>(ptr));
+	} else if (type == Variant::DICTIONARY) {
+		get_singleton()->builtin_payloads.destroy(type, static_cast<Dictionary *>(ptr));
+	}
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::array_proxy_get(duk_context *ctx) {
+	const Array *arr = duk_get_container<Array>(ctx);
+	ERR_FAIL_NULL_V(arr, DUK_ERR_TYPE_ERROR);
+
+	int index = 0;
+	if (duk_get_container_index(ctx, 1, index)) {
+		if (index < arr->size()) {
+			duk_push_godot_variant(ctx, arr->get(index));
+		} else {
+			duk_push_undefined(ctx);
+		}
+	} else if (duk_is_length_key(ctx, 1)) {
+		duk_push_int(ctx, arr->size());
+	} else {
+		duk_dup(ctx, 1);
+		duk_get_prop(ctx, 0);
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::array_proxy_set(duk_context *ctx) {
+	Array *arr = duk_get_container<Array>(ctx);
+	ERR_FAIL_NULL_V(arr, DUK_ERR_TYPE_ERROR);
+
+	int index = 0;
+	if (duk_get_container_index(ctx, 1, index)) {
+		if (index >= arr->size()) {
+			arr->resize(index + 1);
+		}
+		arr->set(index, duk_get_godot_variant(ctx, 2));
+	} else if (duk_is_length_key(ctx, 1)) {
+		const double len = duk_to_number(ctx, 2);
+		if (!(len >= 0 && len <= 0x7FFFFFFF) || len != double(int(len))) {
+			return DUK_RET_RANGE_ERROR;
+		}
+		arr->resize(int(len));
+	} else {
+		duk_dup(ctx, 1);
+		duk_dup(ctx, 2);
+		duk_put_prop(ctx, 0);
+	}
+	duk_push_true(ctx);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::array_proxy_has(duk_context *ctx) {
+	const Array *arr = duk_get_container<Array>(ctx);
+	ERR_FAIL_NULL_V(arr, DUK_ERR_TYPE_ERROR);
+
+	int index = 0;
+	if (duk_get_container_index(ctx, 1, index)) {
+		duk_push_boolean(ctx, index < arr->size());
+	} else if (duk_is_length_key(ctx, 1)) {
+		duk_push_true(ctx);
+	} else {
+		duk_dup(ctx, 1);
+		duk_push_boolean(ctx, duk_has_prop(ctx, 0));
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::array_proxy_delete(duk_context *ctx) {
+	Array *arr = duk_get_container<Array>(ctx);
+	ERR_FAIL_NULL_V(arr, DUK_ERR_TYPE_ERROR);
+
+	int index = 0;
+	if (duk_get_container_index(ctx, 1, index)) {
+		// Deleting an element leaves a hole like it does for ECMAScript arrays
+		if (index < arr->size()) {
+			arr->set(index, Variant());
+		}
+		duk_push_true(ctx);
+	} else if (duk_is_length_key(ctx, 1)) {
+		duk_push_false(ctx);
+	} else {
+		duk_dup(ctx, 1);
+		duk_push_boolean(ctx, duk_del_prop(ctx, 0));
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::array_proxy_own_keys(duk_context *ctx) {
+	const Array *arr = duk_get_container<Array>(ctx);
+	ERR_FAIL_NULL_V(arr, DUK_ERR_TYPE_ERROR);
+
+	// Enumerable placeholders on the target, elements never fall through to them
+	const int size = arr->size();
+	for (int i = duk_get_length(ctx, 0); i < size; ++i) {
+		duk_push_undefined(ctx);
+		duk_put_prop_index(ctx, 0, i);
+	}
+
+	duk_push_array(ctx);
+	for (int i = 0; i < size; ++i) {
+		duk_push_int(ctx, i);
+		duk_to_string(ctx, -1);
+		duk_put_prop_index(ctx, -2, i);
+	}
+	duk_push_literal(ctx, "length");
+	duk_put_prop_index(ctx, -2, size);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::dictionary_proxy_get(duk_context *ctx) {
+	const Dictionary *dict = duk_get_container<Dictionary>(ctx);
+	ERR_FAIL_NULL_V(dict, DUK_ERR_TYPE_ERROR);
+
+	Variant key;
+	if (duk_is_symbol(ctx, 1)) {
+		duk_dup(ctx, 1);
+		duk_get_prop(ctx, 0);
+	} else if (duk_get_dictionary_key(ctx, 1, *dict, key)) {
+		duk_push_godot_variant(ctx, (*dict)[key]);
+	} else {
+		// Inherited properties only, the target's own keys are placeholders
+		duk_get_prototype(ctx, 0);
+		if (duk_is_object(ctx, -1)) {
+			duk_dup(ctx, 1);
+			duk_get_prop(ctx, -2);
+		} else {
+			duk_push_undefined(ctx);
+		}
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::dictionary_proxy_set(duk_context *ctx) {
+	Dictionary *dict = duk_get_container<Dictionary>(ctx);
+	ERR_FAIL_NULL_V(dict, DUK_ERR_TYPE_ERROR);
+
+	if (duk_is_symbol(ctx, 1)) {
+		duk_dup(ctx, 1);
+		duk_dup(ctx, 2);
+		duk_put_prop(ctx, 0);
+	} else {
+		Variant key;
+		duk_get_dictionary_key(ctx, 1, *dict, key);
+		(*dict)[key] = duk_get_godot_variant(ctx, 2);
+	}
+	duk_push_true(ctx);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::dictionary_proxy_has(duk_context *ctx) {
+	const Dictionary *dict = duk_get_container<Dictionary>(ctx);
+	ERR_FAIL_NULL_V(dict, DUK_ERR_TYPE_ERROR);
+
+	Variant key;
+	if (duk_is_symbol(ctx, 1)) {
+		duk_dup(ctx, 1);
+		duk_push_boolean(ctx, duk_has_prop(ctx, 0));
+	} else if (duk_get_dictionary_key(ctx, 1, *dict, key)) {
+		duk_push_true(ctx);
+	} else {
+		duk_get_prototype(ctx, 0);
+		duk_dup(ctx, 1);
+		duk_push_boolean(ctx, duk_is_object(ctx, -2) && duk_has_prop(ctx, -2));
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::dictionary_proxy_delete(duk_context *ctx) {
+	Dictionary *dict = duk_get_container<Dictionary>(ctx);
+	ERR_FAIL_NULL_V(dict, DUK_ERR_TYPE_ERROR);
+
+	Variant key;
+	if (duk_is_symbol(ctx, 1)) {
+		duk_dup(ctx, 1);
+		duk_push_boolean(ctx, duk_del_prop(ctx, 0));
+		return DUK_HAS_RET_VAL;
+	} else if (duk_get_dictionary_key(ctx, 1, *dict, key)) {
+		dict->erase(key);
+	}
+	duk_push_true(ctx);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::dictionary_proxy_own_keys(duk_context *ctx) {
+	const Dictionary *dict = duk_get_container<Dictionary>(ctx);
+	ERR_FAIL_NULL_V(dict, DUK_ERR_TYPE_ERROR);
+
+	duk_push_array(ctx);
+	duk_uarridx_t i = 0;
+	for (const Variant *key = dict->next(NULL); key; key = dict->next(key)) {
+		String es_key = *key;
+		if (!es_key.length()) continue;
+		duk_push_godot_string(ctx, es_key);
+		// Enumerable placeholder on the target, dictionary keys never fall through to it
+		duk_dup_top(ctx);
+		duk_push_undefined(ctx);
+		duk_put_prop(ctx, 0);
+		duk_put_prop_index(ctx, -2, i++);
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+static void duk_push_container_proxy_handler(duk_context *ctx, duk_c_function get, duk_c_function set, duk_c_function has, duk_c_function delete_property, duk_c_function own_keys) {
+	duk_push_object(ctx);
+
+	duk_push_c_function(ctx, get, 3);
+	duk_put_prop_literal(ctx, -2, "get");
+
+	duk_push_c_function(ctx, set, 4);
+	duk_put_prop_literal(ctx, -2, "set");
+
+	duk_push_c_function(ctx, has, 2);
+	duk_put_prop_literal(ctx, -2, "has");
+
+	duk_push_c_function(ctx, delete_property, 2);
+	duk_put_prop_literal(ctx, -2, "deleteProperty");
+
+	duk_push_c_function(ctx, own_keys, 1);
+	duk_put_prop_literal(ctx, -2, "ownKeys");
+}
+
+void DuktapeBindingHelper::register_container_proxy_handlers(duk_context *ctx) {
+	// The heap stash is at the stack top
+	duk_push_c_function(ctx, container_proxy_finalizer, 1);
+	this->duk_ptr_container_proxy_finalizer = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "container_proxy_finalizer");
+
+	duk_push_container_proxy_handler(ctx, array_proxy_get, array_proxy_set, array_proxy_has, array_proxy_delete, array_proxy_own_keys);
+	this->duk_ptr_array_proxy_handler = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "array_proxy_handler");
+
+	duk_push_container_proxy_handler(ctx, dictionary_proxy_get, dictionary_proxy_set, dictionary_proxy_has, dictionary_proxy_delete, dictionary_proxy_own_keys);
+	this->duk_ptr_dictionary_proxy_handler = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "dictionary_proxy_handler");
+}
@@ -0,0 +1,254 @@
+#include "core/os/os.h"
+#include "duktape_binding_helper.h"
+
+/**
+ * Coroutines.
+ *
+ * `godot.start_coroutine(fn)` runs fn in a new Duktape thread until it calls one of the wait functions. The wait
+ * functions are ECMAScript functions yielding a request to the resumer, Duktape only yields from ECMAScript code
+ * that isn't called by a native function. The resumer is an ECMAScript function too as Duktape.Thread.resume
+ * must be called from ECMAScript code.
+ *
+ * The yielded request is an array starting with the private coroutine_wait marker, any other yielded or returned
+ * value ends the coroutine.
+ */
+
+static const char *COROUTINE_RESUME_SOURCE = "(function (thread, value) { return Duktape.Thread.resume(thread, value); })";
+
+// The request kinds are the values of DuktapeBindingHelper::CoroutineWait
+static const char *COROUTINE_WAIT_SOURCE =
+		"(function (wait, check) {\n"
+		"	var yield_ = Duktape.Thread.yield;\n"
+		"	function request(r) { check(r); return yield_(r); }\n"
+		"	return {\n"
+		"		wait_signal: function (object, signal) { return request([wait, 0, object, signal]); },\n"
+		"		wait_seconds: function (seconds) { return request([wait, 1, seconds]); },\n"
+		"		wait_frame: function () { return request([wait, 2]); }\n"
+		"	};\n"
+		"})";
+
+// Connected to the awaited signal, resumes the coroutine on the next frame
+class DuktapeCoroutineSignal : public Object {
+public:
+	uint32_t id;
+	ObjectID source;
+	StringName signal;
+	bool fired;
+
+	virtual Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) {
+		r_error.error = Variant::CallError::CALL_OK;
+		DuktapeBindingHelper::get_singleton()->signal_coroutine(this, p_args, p_argcount);
+		return Variant();
+	}
+
+	DuktapeCoroutineSignal() :
+			id(0),
+			source(0),
+			fired(false) {}
+};
+
+bool DuktapeBindingHelper::check_coroutine_wait(duk_context *ctx) {
+	duk_push_current_thread(ctx);
+	const bool in_coroutine = duk_has_prop_literal(ctx, -1, DUK_HIDDEN_SYMBOL("coroutine"));
+	duk_pop(ctx);
+	if (!in_coroutine) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Waits are only allowed in coroutines started by godot.start_coroutine()");
+		return false;
+	}
+
+	duk_get_prop_index(ctx, 0, 1);
+	const duk_int_t wait = duk_get_int(ctx, -1);
+	duk_pop(ctx);
+	if (wait == COROUTINE_WAIT_SIGNAL) {
+		duk_get_prop_index(ctx, 0, 2);
+		Object *obj = duk_get_godot_object(ctx, -1);
+		duk_pop(ctx);
+		duk_get_prop_index(ctx, 0, 3);
+		const bool valid = obj && duk_is_string(ctx, -1) && obj->has_signal(duk_get_godot_string_name(ctx, -1));
+		duk_pop(ctx);
+		if (!valid) {
+			duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Waiting for an unknown signal");
+			return false;
+		}
+	}
+	return true;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_check_coroutine_wait(duk_context *ctx) {
+	// Errors are thrown from here where no engine objects are alive on the native stack
+	if (!check_coroutine_wait(ctx)) {
+		return duk_throw(ctx);
+	}
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_start_coroutine(duk_context *ctx) {
+	if (!duk_is_function(ctx, 0)) {
+		return DUK_RET_TYPE_ERROR;
+	}
+	DuktapeBindingHelper *self = get_singleton();
+	const uint32_t id = ++self->last_coroutine_id;
+
+	// The initial function must be the only value of a thread started by Duktape.Thread.resume
+	duk_push_heapptr(ctx, self->coroutine_pool_ptr);
+	duk_push_thread(ctx);
+	duk_context *coroutine = duk_get_context(ctx, -1);
+	duk_push_true(ctx);
+	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("coroutine"));
+	duk_dup(ctx, 0);
+	duk_xmove_top(coroutine, ctx, 1);
+	duk_put_prop_index(ctx, -2, id);
+	duk_pop(ctx);
+
+	self->resume_coroutine(ctx, id, Variant());
+	return DUK_NO_RET_VAL;
+}
+
+void DuktapeBindingHelper::register_coroutines(duk_context *ctx) {
+	const duk_idx_t godot_idx = duk_get_top_index(ctx);
+
+	duk_push_heap_stash(ctx);
+	duk_push_object(ctx);
+	coroutine_pool_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "coroutines");
+	duk_eval_string(ctx, COROUTINE_RESUME_SOURCE);
+	coroutine_resume_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "coroutine_resume");
+	duk_push_bare_object(ctx);
+	coroutine_wait_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "coroutine_wait");
+	duk_pop(ctx);
+	last_coroutine_id = 0;
+
+	duk_push_literal(ctx, "start_coroutine");
+	duk_push_c_function(ctx, godot_start_coroutine, 1);
+	duk_def_prop(ctx, godot_idx, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+	duk_eval_string(ctx, COROUTINE_WAIT_SOURCE);
+	duk_push_heapptr(ctx, coroutine_wait_ptr);
+	duk_push_c_function(ctx, godot_check_coroutine_wait, 1);
+	duk_call(ctx, 2);
+	{
+		duk_push_literal(ctx, "wait_signal");
+		duk_get_prop_literal(ctx, -2, "wait_signal");
+		duk_def_prop(ctx, godot_idx, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "wait_seconds");
+		duk_get_prop_literal(ctx, -2, "wait_seconds");
+		duk_def_prop(ctx, godot_idx, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+
+		duk_push_literal(ctx, "wait_frame");
+		duk_get_prop_literal(ctx, -2, "wait_frame");
+		duk_def_prop(ctx, godot_idx, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_ENUMERABLE);
+	}
+	duk_pop(ctx);
+}
+
+void DuktapeBindingHelper::resume_coroutine(duk_context *ctx, uint32_t p_id, const Variant &p_value) {
+	duk_push_heapptr(ctx, coroutine_resume_ptr);
+	duk_push_heapptr(ctx, coroutine_pool_ptr);
+	duk_get_prop_index(ctx, -1, p_id);
+	duk_remove(ctx, -2);
+	duk_push_godot_variant(ctx, p_value);
+
+	bool waiting = false;
+	WatchdogScope watchdog(this);
+	if (DUK_EXEC_SUCCESS != duk_pcall(ctx, 2)) {
+		duk_print_error(ctx, -1);
+	} else {
+		waiting = wait_coroutine(ctx, p_id);
+	}
+	duk_pop(ctx);
+
+	if (!waiting) {
+		// Finished or failed, the thread is released
+		duk_push_heapptr(ctx, coroutine_pool_ptr);
+		duk_del_prop_index(ctx, -1, p_id);
+		duk_pop(ctx);
+	}
+}
+
+bool DuktapeBindingHelper::wait_coroutine(duk_context *ctx, uint32_t p_id) {
+	if (!duk_is_array(ctx, -1)) return false;
+	duk_get_prop_index(ctx, -1, 0);
+	const bool is_wait = duk_get_heapptr(ctx, -1) == coroutine_wait_ptr;
+	duk_pop(ctx);
+	if (!is_wait) return false;
+
+	duk_get_prop_index(ctx, -1, 1);
+	const duk_int_t wait = duk_get_int(ctx, -1);
+	duk_pop(ctx);
+
+	switch (wait) {
+		case COROUTINE_WAIT_SIGNAL: {
+			duk_get_prop_index(ctx, -1, 2);
+			Object *obj = duk_get_godot_object(ctx, -1);
+			duk_pop(ctx);
+			duk_get_prop_index(ctx, -1, 3);
+			const StringName signal = duk_get_godot_string_name(ctx, -1);
+			duk_pop(ctx);
+			// The object may have been freed by another thread since the request was checked
+			ERR_FAIL_NULL_V(obj, false);
+
+			DuktapeCoroutineSignal *receiver = memnew(DuktapeCoroutineSignal);
+			receiver->id = p_id;
+			receiver->source = obj->get_instance_id();
+			receiver->signal = signal;
+			if (OK != obj->connect(signal, receiver, "_resume")) {
+				memdelete(receiver);
+				ERR_FAIL_V(false);
+			}
+			coroutine_signals.set(p_id, receiver);
+		} break;
+		case COROUTINE_WAIT_SECONDS: {
+			duk_get_prop_index(ctx, -1, 2);
+			const double seconds = duk_get_number_default(ctx, -1, 0);
+			duk_pop(ctx);
+			const uint64_t usec = seconds > 0 ? uint64_t(seconds * 1000000.0) : 0;
+			coroutine_timers.push(OS::get_singleton()->get_ticks_usec() + usec, p_id);
+		} break;
+		default: {
+			const CoroutineResume resume = { p_id, Variant() };
+			ready_coroutines.push_back(resume);
+		} break;
+	}
+	return true;
+}
+
+void DuktapeBindingHelper::signal_coroutine(DuktapeCoroutineSignal *p_receiver, const Variant **p_args, int p_argcount) {
+	HeapLock lock(this);
+	// Only the first emission is delivered, the receiver is disconnected when the coroutine resumes
+	if (p_receiver->fired) return;
+	p_receiver->fired = true;
+
+	Array args;
+	args.resize(p_argcount);
+	for (int i = 0; i < p_argcount; ++i) {
+		args[i] = *p_args[i];
+	}
+	const CoroutineResume resume = { p_receiver->id, args };
+	ready_coroutines.push_back(resume);
+}
+
+void DuktapeBindingHelper::resume_coroutines() {
+	// Coroutines waiting for a frame again are resumed on the next one
+	Vector<CoroutineResume> ready = ready_coroutines;
+	ready_coroutines.clear();
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	while (coroutine_timers.has_due(now)) {
+		const CoroutineResume resume = { coroutine_timers.pop(), Variant() };
+		ready.push_back(resume);
+	}
+
+	for (int i = 0; i < ready.size(); ++i) {
+		const CoroutineResume &resume = ready[i];
+		if (DuktapeCoroutineSignal **receiver = coroutine_signals.getptr(resume.id)) {
+			if (Object *source = ObjectDB::get_instance((*receiver)->source)) {
+				source->disconnect((*receiver)->signal, *receiver, "_resume");
+			}
+			memdelete(*receiver);
+			coroutine_signals.erase(resume.id);
+		}
+		resume_coroutine(ctx, resume.id, resume.value);
+	}
+}
@@ -0,0 +1,292 @@
+#include "core/os/os.h"
+#include "duktape_binding_helper.h"
+
+/**
+ * Promise, job queue and timers.
+ *
+ * The Promise builtin of Duktape 2.3 is only a placeholder throwing "unimplemented", so Promise is provided by
+ * the ECMAScript source below. Its reactions are queued as jobs in the jobs array of the heap stash and run by
+ * run_jobs() until the queue is empty, after each timer callback and once per frame.
+ *
+ * setTimeout and setInterval keep [callback, interval, ...args] in the timers object of the heap stash keyed by
+ * the timer id and the due times in a DuktapeTimerHeap. Cleared timers are only removed from the stash, their
+ * heap entries are dropped when they come due.
+ */
+
+static const char *PROMISE_SOURCE =
+		"(function (enqueue, report) {\n"
+		"	'use strict';\n"
+		"	var PENDING = 0, FULFILLED = 1, REJECTED = 2;\n"
+		"	function schedule(p, r) {\n"
+		"		enqueue(function () {\n"
+		"			var handler = p._state === FULFILLED ? r.fulfilled : r.rejected;\n"
+		"			if (typeof handler !== 'function') {\n"
+		"				if (p._state === FULFILLED) r.resolve(p._value); else r.reject(p._value);\n"
+		"				return;\n"
+		"			}\n"
+		"			var result;\n"
+		"			try { result = handler(p._value); } catch (e) { r.reject(e); return; }\n"
+		"			r.resolve(result);\n"
+		"		});\n"
+		"	}\n"
+		"	function settle(p, state, value) {\n"
+		"		var reactions = p._reactions;\n"
+		"		p._state = state;\n"
+		"		p._value = value;\n"
+		"		p._reactions = undefined;\n"
+		"		for (var i = 0; i < reactions.length; i++) schedule(p, reactions[i]);\n"
+		"		if (state === REJECTED && !p._handled) {\n"
+		"			enqueue(function () { if (!p._handled) report(value); });\n"
+		"		}\n"
+		"	}\n"
+		"	function resolve_value(p, value) {\n"
+		"		if (value === p) { settle(p, REJECTED, new TypeError('A promise cannot be resolved with itself')); return; }\n"
+		"		if (value !== null && (typeof value === 'object' || typeof value === 'function')) {\n"
+		"			var then;\n"
+		"			try { then = value.then; } catch (e) { settle(p, REJECTED, e); return; }\n"
+		"			if (typeof then === 'function') {\n"
+		"				var fns = resolvers(p);\n"
+		"				enqueue(function () {\n"
+		"					try { then.call(value, fns.resolve, fns.reject); } catch (e) { fns.reject(e); }\n"
+		"				});\n"
+		"				return;\n"
+		"			}\n"
+		"		}\n"
+		"		settle(p, FULFILLED, value);\n"
+		"	}\n"
+		"	function resolvers(p) {\n"
+		"		var done = false;\n"
+		"		return {\n"
+		"			resolve: function (value) { if (done) return; done = true; resolve_value(p, value); },\n"
+		"			reject: function (reason) { if (done) return; done = true; settle(p, REJECTED, reason); }\n"
+		"		};\n"
+		"	}\n"
+		"	function Promise(executor) {\n"
+		"		if (!(this instanceof Promise)) throw new TypeError('Promise must be called with new');\n"
+		"		if (typeof executor !== 'function') throw new TypeError('Promise resolver is not a function');\n"
+		"		Object.defineProperties(this, {\n"
+		"			_state: { value: PENDING, writable: true },\n"
+		"			_value: { value: undefined, writable: true },\n"
+		"			_reactions: { value: [], writable: true },\n"
+		"			_handled: { value: false, writable: true }\n"
+		"		});\n"
+		"		var fns = resolvers(this);\n"
+		"		try { executor(fns.resolve, fns.reject); } catch (e) { fns.reject(e); }\n"
+		"	}\n"
+		"	Promise.prototype.then = function (on_fulfilled, on_rejected) {\n"
+		"		if (!(this instanceof Promise)) throw new TypeError('Promise.prototype.then called on a non promise');\n"
+		"		var r = { fulfilled: on_fulfilled, rejected: on_rejected };\n"
+		"		var next = new Promise(function (resolve, reject) { r.resolve = resolve; r.reject = reject; });\n"
+		"		this._handled = true;\n"
+		"		if (this._state === PENDING) this._reactions.push(r); else schedule(this, r);\n"
+		"		return next;\n"
+		"	};\n"
+		"	Promise.prototype['catch'] = function (on_rejected) { return this.then(undefined, on_rejected); };\n"
+		"	Promise.prototype['finally'] = function (callback) {\n"
+		"		if (typeof callback !== 'function') return this.then(callback, callback);\n"
+		"		return this.then(\n"
+		"			function (value) { return Promise.resolve(callback()).then(function () { return value; }); },\n"
+		"			function (reason) { return Promise.resolve(callback()).then(function () { throw reason; }); });\n"
+		"	};\n"
+		"	Promise.resolve = function (value) {\n"
+		"		if (value instanceof Promise) return value;\n"
+		"		return new Promise(function (resolve) { resolve(value); });\n"
+		"	};\n"
+		"	Promise.reject = function (reason) {\n"
+		"		return new Promise(function (resolve, reject) { reject(reason); });\n"
+		"	};\n"
+		"	Promise.all = function (values) {\n"
+		"		return new Promise(function (resolve, reject) {\n"
+		"			var results = new Array(values.length), remaining = values.length;\n"
+		"			if (remaining === 0) { resolve(results); return; }\n"
+		"			for (var i = 0; i < values.length; i++) (function (i) {\n"
+		"				Promise.resolve(values[i]).then(function (value) {\n"
+		"					results[i] = value;\n"
+		"					if (--remaining === 0) resolve(results);\n"
+		"				}, reject);\n"
+		"			})(i);\n"
+		"		});\n"
+		"	};\n"
+		"	Promise.race = function (values) {\n"
+		"		return new Promise(function (resolve, reject) {\n"
+		"			for (var i = 0; i < values.length; i++) Promise.resolve(values[i]).then(resolve, reject);\n"
+		"		});\n"
+		"	};\n"
+		"	return Promise;\n"
+		"})";
+
+duk_ret_t DuktapeBindingHelper::godot_enqueue_job(duk_context *ctx) {
+	DuktapeBindingHelper *self = get_singleton();
+	duk_push_heapptr(ctx, self->job_queue_ptr);
+	duk_dup(ctx, 0);
+	duk_put_prop_index(ctx, -2, self->pending_jobs++);
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_unhandled_rejection(duk_context *ctx) {
+	if (duk_is_error(ctx, 0)) {
+		duk_get_prop_literal(ctx, 0, "stack");
+		if (duk_is_string(ctx, -1)) {
+			duk_replace(ctx, 0);
+		} else {
+			duk_pop(ctx);
+		}
+	}
+	ERR_PRINTS(String("Unhandled promise rejection: ") + duk_safe_to_string(ctx, 0));
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_set_timer(duk_context *ctx) {
+	const duk_idx_t argc = duk_get_top(ctx);
+	if (!duk_is_function(ctx, 0)) {
+		return DUK_RET_TYPE_ERROR;
+	}
+	const bool repeat = duk_get_current_magic(ctx) != 0;
+	const double delay = argc > 1 ? duk_to_number(ctx, 1) : 0;
+	const uint64_t delay_usec = delay > 0 ? uint64_t(delay * 1000.0) : 0;
+
+	DuktapeBindingHelper *self = get_singleton();
+	const uint32_t id = ++self->last_timer_id;
+
+	duk_push_heapptr(ctx, self->timer_pool_ptr);
+	duk_push_array(ctx);
+	duk_dup(ctx, 0);
+	duk_put_prop_index(ctx, -2, 0);
+	if (repeat) {
+		duk_push_number(ctx, double(delay_usec));
+	} else {
+		duk_push_undefined(ctx);
+	}
+	duk_put_prop_index(ctx, -2, 1);
+	for (duk_idx_t i = 2; i < argc; ++i) {
+		duk_dup(ctx, i);
+		duk_put_prop_index(ctx, -2, i);
+	}
+	duk_put_prop_index(ctx, -2, id);
+	duk_pop(ctx);
+
+	self->timers.push(OS::get_singleton()->get_ticks_usec() + delay_usec, id);
+	duk_push_uint(ctx, id);
+	return DUK_HAS_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_clear_timer(duk_context *ctx) {
+	if (duk_is_number(ctx, 0)) {
+		duk_push_heapptr(ctx, get_singleton()->timer_pool_ptr);
+		duk_del_prop_index(ctx, -1, duk_get_uint(ctx, 0));
+	}
+	return DUK_NO_RET_VAL;
+}
+
+void DuktapeBindingHelper::register_event_loop(duk_context *ctx) {
+	duk_push_heap_stash(ctx);
+	duk_push_array(ctx);
+	job_queue_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "jobs");
+	duk_push_object(ctx);
+	timer_pool_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "timers");
+	duk_pop(ctx);
+	pending_jobs = 0;
+	last_timer_id = 0;
+
+	duk_push_global_object(ctx);
+	{
+		duk_push_literal(ctx, "Promise");
+		duk_eval_string(ctx, PROMISE_SOURCE);
+		duk_push_c_function(ctx, godot_enqueue_job, 1);
+		duk_push_c_function(ctx, godot_unhandled_rejection, 1);
+		duk_call(ctx, 2);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "setTimeout");
+		duk_push_c_function(ctx, godot_set_timer, DUK_VARARGS);
+		duk_set_magic(ctx, -1, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "setInterval");
+		duk_push_c_function(ctx, godot_set_timer, DUK_VARARGS);
+		duk_set_magic(ctx, -1, 1);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "clearTimeout");
+		duk_push_c_function(ctx, godot_clear_timer, 1);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "clearInterval");
+		duk_push_c_function(ctx, godot_clear_timer, 1);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+	}
+	duk_pop(ctx);
+}
+
+void DuktapeBindingHelper::run_jobs(duk_context *ctx) {
+	// Jobs queued by the running ones are run in the same pass
+	while (pending_jobs) {
+		const uint32_t count = pending_jobs;
+		pending_jobs = 0;
+
+		// The old queue stays reachable from the value stack
+		duk_push_heapptr(ctx, job_queue_ptr);
+		duk_push_heap_stash(ctx);
+		duk_push_array(ctx);
+		job_queue_ptr = duk_get_heapptr(ctx, -1);
+		duk_put_prop_literal(ctx, -2, "jobs");
+		duk_pop(ctx);
+
+		for (uint32_t i = 0; i < count; ++i) {
+			duk_get_prop_index(ctx, -1, i);
+			WatchdogScope watchdog(this);
+			if (DUK_EXEC_SUCCESS != duk_pcall(ctx, 0)) {
+				duk_print_error(ctx, -1);
+			}
+			duk_pop(ctx);
+		}
+		duk_pop(ctx);
+	}
+}
+
+void DuktapeBindingHelper::run_timers(duk_context *ctx, uint64_t p_now_usec) {
+	while (timers.has_due(p_now_usec)) {
+		const uint32_t id = timers.pop();
+
+		duk_push_heapptr(ctx, timer_pool_ptr);
+		const duk_idx_t pool_idx = duk_get_top_index(ctx);
+		duk_get_prop_index(ctx, pool_idx, id);
+		if (!duk_is_array(ctx, -1)) {
+			// cleared
+			duk_pop_2(ctx);
+			continue;
+		}
+		const duk_idx_t timer_idx = duk_get_top_index(ctx);
+		const duk_idx_t argc = duk_idx_t(duk_get_length(ctx, timer_idx)) - 2;
+
+		duk_get_prop_index(ctx, timer_idx, 1);
+		const bool repeat = duk_is_number(ctx, -1);
+		const uint64_t interval_usec = repeat ? uint64_t(duk_get_number(ctx, -1)) : 0;
+		duk_pop(ctx);
+		if (!repeat) {
+			duk_del_prop_index(ctx, pool_idx, id);
+		}
+
+		duk_require_stack(ctx, argc + 2);
+		duk_get_prop_index(ctx, timer_idx, 0);
+		duk_push_undefined(ctx);
+		for (duk_idx_t i = 0; i < argc; ++i) {
+			duk_get_prop_index(ctx, timer_idx, i + 2);
+		}
+		WatchdogScope watchdog(this);
+		if (DUK_EXEC_SUCCESS != duk_pcall_method(ctx, argc)) {
+			duk_print_error(ctx, -1);
+		}
+		duk_pop(ctx);
+
+		// Intervals keep running until their callback clears them, at most once per frame
+		if (repeat && duk_has_prop_index(ctx, pool_idx, id)) {
+			timers.push(p_now_usec + MAX(interval_usec, uint64_t(1)), id);
+		}
+		duk_pop_2(ctx);
+
+		run_jobs(ctx);
+	}
+}
@@ -0,0 +1,107 @@
+#include "duktape_heap_accounting.h"
+#include "core/print_string.h"
+
+bool DuktapeHeapAccounting::check_limit(size_t p_size, size_t p_growth) {
+	if (live_bytes + p_growth <= limit) {
+		refused_size = 0;
+		return true;
+	}
+	if (refused_size && p_size != refused_size && live_bytes + p_growth <= limit + LIMIT_HEADROOM) {
+		return true;
+	}
+	// Failing outside of protected calls would abort
+	if (!duk_has_catcher(ctx)) {
+		return true;
+	}
+	refused_size = p_size;
+	return false;
+}
+
+void *DuktapeHeapAccounting::alloc(size_t p_size) {
+	if (limit && !check_limit(p_size, p_size)) return NULL;
+	Header *header = static_cast<Header *>(memalloc(sizeof(Header) + p_size));
+	if (NULL == header) return NULL;
+	header->size = p_size;
+	live_allocations++;
+	count_allocation(p_size);
+	return header + 1;
+}
+
+void *DuktapeHeapAccounting::realloc(void *p_ptr, size_t p_size) {
+	if (NULL == p_ptr) {
+		return alloc(p_size);
+	}
+	if (0 == p_size) {
+		free(p_ptr);
+		return NULL;
+	}
+
+	Header *header = static_cast<Header *>(p_ptr) - 1;
+	const size_t old_size = header->size;
+	if (limit && p_size > old_size && !check_limit(p_size, p_size - old_size)) return NULL;
+	header = static_cast<Header *>(memrealloc(header, sizeof(Header) + p_size));
+	if (NULL == header) return NULL; // the old block is still valid
+	header->size = p_size;
+	live_bytes -= old_size;
+	count_allocation(p_size);
+	return header + 1;
+}
+
+void DuktapeHeapAccounting::free(void *p_ptr) {
+	if (NULL == p_ptr) return;
+	Header *header = static_cast<Header *>(p_ptr) - 1;
+	live_bytes -= header->size;
+	live_allocations--;
+	memfree(header);
+}
+
+Dictionary DuktapeHeapAccounting::get_stats_dictionary() const {
+	Dictionary ret;
+	ret["live_bytes"] = live_bytes;
+	ret["peak_bytes"] = peak_bytes;
+	ret["live_allocations"] = live_allocations;
+	ret["total_allocations"] = total_allocations;
+	ret["limit_bytes"] = limit;
+	Array histogram;
+	histogram.resize(HISTOGRAM_BUCKETS);
+	for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		histogram[i] = size_histogram[i];
+	}
+	ret["size_histogram"] = histogram;
+	return ret;
+}
+
+void DuktapeHeapAccounting::dump(duk_context *ctx) const {
+	print_line(vformat("ECMAScript heap: %s live in %d allocations, %s peak", String::humanize_size(live_bytes), live_allocations, String::humanize_size(peak_bytes)));
+
+	duk_heap_usage usage;
+	duk_get_heap_usage(ctx, &usage);
+	print_line(vformat("  strings    %8d  %s", uint64_t(usage.string_count), String::humanize_size(usage.string_bytes)));
+	print_line(vformat("  objects    %8d  %s", uint64_t(usage.object_count), String::humanize_size(usage.object_bytes)));
+	print_line(vformat("  functions  %8d  %s", uint64_t(usage.function_count), String::humanize_size(usage.function_bytes)));
+	print_line(vformat("  bytecode             %s", String::humanize_size(usage.bytecode_bytes)));
+	print_line(vformat("  threads    %8d  %s", uint64_t(usage.thread_count), String::humanize_size(usage.thread_bytes)));
+	print_line(vformat("  buffers    %8d  %s", uint64_t(usage.buffer_count), String::humanize_size(usage.buffer_bytes)));
+	const uint64_t counted = usage.string_bytes + usage.object_bytes + usage.function_bytes + usage.bytecode_bytes + usage.thread_bytes + usage.buffer_bytes;
+	// Allocator headers, the string table and the call stacks
+	print_line(vformat("  other                %s", String::humanize_size(live_bytes > counted ? live_bytes - counted : 0)));
+
+	print_line("Allocation sizes:");
+	for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		const String size = i < HISTOGRAM_BUCKETS - 1 ? "<= " + String::humanize_size(16 << i) : "> " + String::humanize_size(16 << (i - 1));
+		print_line(vformat("  %-12s %d", size, size_histogram[i]));
+	}
+}
+
+DuktapeHeapAccounting::DuktapeHeapAccounting() :
+		live_bytes(0),
+		peak_bytes(0),
+		live_allocations(0),
+		total_allocations(0),
+		limit(0),
+		ctx(NULL),
+		refused_size(0) {
+	for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+		size_histogram[i] = 0;
+	}
+}
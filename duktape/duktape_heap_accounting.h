@@ -0,0 +1,78 @@
+#ifndef DUKTAPE_HEAP_ACCOUNTING_H
+#define DUKTAPE_HEAP_ACCOUNTING_H
+
+#include "core/os/memory.h"
+#include "core/variant.h"
+#include "src/duktape.h"
+
+/**
+ * Memory of a Duktape heap, counted by its allocator functions.
+ * Every allocation is prefixed with a header holding its size so frees and reallocations are accounted exactly.
+ * The allocator functions of a heap are only called by the thread running it.
+ *
+ * With a limit, allocations that would exceed it fail while the error can be caught. Duktape then runs emergency
+ * garbage collections and retries the same request, and throws a RangeError if it still fails. Once a request was
+ * refused, other requests may use LIMIT_HEADROOM bytes above the limit so the error can be created and handled.
+ */
+class DuktapeHeapAccounting {
+public:
+	enum {
+		HISTOGRAM_BUCKETS = 12, // 16 bytes, 32 bytes ... 16 KiB and larger
+		LIMIT_HEADROOM = 64 * 1024,
+	};
+
+private:
+	union Header {
+		size_t size;
+		uint8_t align[16];
+	};
+
+	uint64_t live_bytes;
+	uint64_t peak_bytes;
+	uint32_t live_allocations;
+	uint64_t total_allocations;
+	uint64_t size_histogram[HISTOGRAM_BUCKETS]; // allocations and reallocations by requested size
+	uint64_t limit; // 0 for no limit
+	duk_context *ctx; // any context of the limited heap
+	size_t refused_size; // last refused request while over the limit, retried by Duktape after collecting
+
+	bool check_limit(size_t p_size, size_t p_growth);
+
+	static _FORCE_INLINE_ int get_bucket(size_t p_size) {
+		int bucket = 0;
+		for (size_t bucket_size = 16; p_size > bucket_size && bucket < HISTOGRAM_BUCKETS - 1; bucket_size <<= 1) {
+			++bucket;
+		}
+		return bucket;
+	}
+
+	_FORCE_INLINE_ void count_allocation(size_t p_size) {
+		live_bytes += p_size;
+		if (live_bytes > peak_bytes) {
+			peak_bytes = live_bytes;
+		}
+		total_allocations++;
+		size_histogram[get_bucket(p_size)]++;
+	}
+
+public:
+	_FORCE_INLINE_ void set_limit(duk_context *p_ctx, uint64_t p_bytes) {
+		ctx = p_ctx;
+		limit = p_bytes;
+	}
+	_FORCE_INLINE_ uint64_t get_limit() const { return limit; }
+
+	void *alloc(size_t p_size);
+	void *realloc(void *p_ptr, size_t p_size);
+	void free(void *p_ptr);
+
+	_FORCE_INLINE_ uint64_t get_live_bytes() const { return live_bytes; }
+	_FORCE_INLINE_ uint64_t get_peak_bytes() const { return peak_bytes; }
+	Dictionary get_stats_dictionary() const;
+	// Prints the counters and the heap usage by value category of ctx
+	void dump(duk_context *ctx) const;
+
+	DuktapeHeapAccounting();
+};
+
+#endif // DUKTAPE_HEAP_ACCOUNTING_H
@@ -0,0 +1,663 @@
+#include "duktape_message.h"
+#include "core/io/marshalls.h"
+#include "duktape_binding_helper.h"
+
+uint8_t *DuktapeMessage::reserve(int p_size) {
+	const int pos = data.size();
+	data.resize(pos + p_size);
+	return data.ptrw() + pos;
+}
+
+void DuktapeMessage::put_u8(uint8_t p_value) {
+	*reserve(1) = p_value;
+}
+
+void DuktapeMessage::put_u32(uint32_t p_value) {
+	encode_uint32(p_value, reserve(4));
+}
+
+void DuktapeMessage::put_bytes(const void *p_data, int p_size) {
+	if (p_size > 0) {
+		copymem(reserve(p_size), p_data, p_size);
+	}
+}
+
+void DuktapeMessage::put_string(const char *p_str, int p_length) {
+	put_u8(TAG_STRING);
+	put_u32(p_length);
+	put_bytes(p_str, p_length);
+}
+
+template <class T>
+static Variant take_pool_array(void *p_ptr) {
+	T *ptr = static_cast<T *>(p_ptr);
+	Variant ret = *ptr;
+	*ptr = T();
+	return ret;
+}
+
+bool DuktapeMessage::put_transfer(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx, bool &r_transferred) {
+	r_transferred = false;
+	if (transfer_idx == DUK_INVALID_INDEX || !duk_is_array(ctx, transfer_idx)) {
+		return true;
+	}
+
+	const void *ptr = duk_get_heapptr(ctx, idx);
+	const duk_size_t count = duk_get_length(ctx, transfer_idx);
+	for (duk_size_t i = 0; i < count; ++i) {
+		duk_get_prop_index(ctx, transfer_idx, i);
+		const bool found = duk_get_heapptr(ctx, -1) == ptr;
+		duk_pop(ctx);
+		if (!found) continue;
+
+		switch (duk_get_native_tag(ctx, idx, Variant::NIL)) {
+			case TYPE_POOL_ARRAY_VIEW:
+			case Variant::POOL_BYTE_ARRAY:
+			case Variant::POOL_INT_ARRAY:
+			case Variant::POOL_REAL_ARRAY:
+			case Variant::POOL_VECTOR2_ARRAY:
+			case Variant::POOL_VECTOR3_ARRAY:
+			case Variant::POOL_COLOR_ARRAY:
+				break;
+			default:
+				if (!duk_is_buffer_data(ctx, idx)) {
+					duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Only pool arrays and typed arrays can be transferred");
+					return false;
+				}
+				break;
+		}
+
+		// Transferables are identified by their position in the transfer list, the sender keeps them until the
+		// whole value is encoded so a failing message loses nothing
+		if (pending_transfers.find(i) == -1) {
+			pending_transfers.push_back(i);
+		}
+		put_u8(TAG_TRANSFER);
+		put_u32(i);
+		r_transferred = true;
+		return true;
+	}
+	return true;
+}
+
+Variant DuktapeMessage::take_transferable(duk_context *ctx, duk_idx_t idx) {
+	void *native = duk_get_native_ptr(ctx, idx);
+	switch (duk_get_native_tag(ctx, idx, Variant::NIL)) {
+		case TYPE_POOL_ARRAY_VIEW:
+			return DuktapeBindingHelper::duk_detach_pool_array_view(ctx, idx);
+		case Variant::POOL_BYTE_ARRAY:
+			return take_pool_array<PoolByteArray>(native);
+		case Variant::POOL_INT_ARRAY:
+			return take_pool_array<PoolIntArray>(native);
+		case Variant::POOL_REAL_ARRAY:
+			return take_pool_array<PoolRealArray>(native);
+		case Variant::POOL_VECTOR2_ARRAY:
+			return take_pool_array<PoolVector2Array>(native);
+		case Variant::POOL_VECTOR3_ARRAY:
+			return take_pool_array<PoolVector3Array>(native);
+		case Variant::POOL_COLOR_ARRAY:
+			return take_pool_array<PoolColorArray>(native);
+		default:
+			// Storage allocated by the heap can't change owner, it is copied once
+			if (duk_is_buffer_data(ctx, idx)) {
+				return DuktapeBindingHelper::duk_get_godot_buffer_data(ctx, idx);
+			}
+			// The transfer list was changed by a getter while encoding
+			return Variant();
+	}
+}
+
+bool DuktapeMessage::put_value(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx, Vector<const void *> &r_parents) {
+	idx = duk_normalize_index(ctx, idx);
+	duk_require_stack(ctx, 4);
+
+	switch (duk_get_type(ctx, idx)) {
+		case DUK_TYPE_NONE:
+		case DUK_TYPE_UNDEFINED:
+			put_u8(TAG_UNDEFINED);
+			return true;
+		case DUK_TYPE_NULL:
+		case DUK_TYPE_POINTER:
+			put_u8(TAG_NULL);
+			return true;
+		case DUK_TYPE_BOOLEAN:
+			put_u8(duk_get_boolean(ctx, idx) ? TAG_TRUE : TAG_FALSE);
+			return true;
+		case DUK_TYPE_NUMBER: {
+			const double num = duk_get_number(ctx, idx);
+			if (num >= -2147483648.0 && num <= 2147483647.0 && double(int32_t(num)) == num && !(num == 0 && 1.0 / num < 0)) {
+				put_u8(TAG_INT);
+				put_u32(uint32_t(int32_t(num)));
+			} else {
+				put_u8(TAG_DOUBLE);
+				encode_double(num, reserve(8));
+			}
+			return true;
+		}
+		case DUK_TYPE_STRING: {
+			duk_size_t length = 0;
+			const char *str = duk_get_lstring(ctx, idx, &length);
+			put_string(str, length);
+			return true;
+		}
+		case DUK_TYPE_BUFFER: {
+			duk_size_t length = 0;
+			const void *buffer = duk_get_buffer(ctx, idx, &length);
+			put_u8(TAG_BUFFER);
+			put_u8(DUK_BUFOBJ_UINT8ARRAY);
+			put_u32(length);
+			put_bytes(buffer, length);
+			return true;
+		}
+		case DUK_TYPE_OBJECT:
+			break;
+		default:
+			duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Functions could not be cloned");
+			return false;
+	}
+
+	bool transferred = false;
+	if (!put_transfer(ctx, idx, transfer_idx, transferred)) {
+		return false;
+	}
+	if (transferred) {
+		return true;
+	}
+
+	const int tag = duk_get_native_tag(ctx, idx, Variant::NIL);
+	if (tag == TYPE_POOL_ARRAY_VIEW || (tag == Variant::NIL && duk_is_buffer_data(ctx, idx))) {
+		duk_size_t length = 0;
+		const void *buffer = duk_get_buffer_data(ctx, idx, &length);
+		const int type = duk_get_buffer_object_type(ctx, idx);
+		put_u8(TAG_BUFFER);
+		put_u8(type < 0 ? DUK_BUFOBJ_UINT8ARRAY : type);
+		put_u32(length);
+		put_bytes(buffer, length);
+		return true;
+	} else if (tag == Variant::OBJECT || tag == TYPE_GODOT_REFERENCE || duk_is_function(ctx, idx)) {
+		duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Functions and godot objects could not be cloned");
+		return false;
+	} else if (tag != Variant::NIL) {
+		// builtin values, pool arrays and lazily marshalled containers of the main heap
+		put_variant(DuktapeBindingHelper::duk_get_godot_variant(ctx, idx));
+		return true;
+	}
+
+	const void *ptr = duk_get_heapptr(ctx, idx);
+	if (r_parents.find(ptr) != -1) {
+		duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Cyclic values could not be cloned");
+		return false;
+	}
+	r_parents.push_back(ptr);
+
+	if (duk_is_array(ctx, idx)) {
+		const duk_size_t length = duk_get_length(ctx, idx);
+		put_u8(TAG_ARRAY);
+		put_u32(length);
+		for (duk_size_t i = 0; i < length; ++i) {
+			duk_get_prop_index(ctx, idx, i);
+			if (!put_value(ctx, -1, transfer_idx, r_parents)) {
+				return false;
+			}
+			duk_pop(ctx);
+		}
+	} else {
+		put_u8(TAG_OBJECT);
+		const int count_pos = data.size();
+		put_u32(0);
+		uint32_t count = 0;
+		duk_enum(ctx, idx, DUK_ENUM_OWN_PROPERTIES_ONLY);
+		while (duk_next(ctx, -1, true)) {
+			duk_size_t length = 0;
+			const char *key = duk_to_lstring(ctx, -2, &length);
+			put_u32(length);
+			put_bytes(key, length);
+			if (!put_value(ctx, -1, transfer_idx, r_parents)) {
+				return false;
+			}
+			duk_pop_2(ctx);
+			++count;
+		}
+		duk_pop(ctx);
+		encode_uint32(count, data.ptrw() + count_pos);
+	}
+
+	r_parents.resize(r_parents.size() - 1);
+	return true;
+}
+
+template <class T>
+void DuktapeMessage::put_pool_data(Variant::Type p_type, const T &p_array) {
+	typename T::Read r = p_array.read();
+	const uint32_t length = p_array.size() * sizeof(*r.ptr());
+	put_u8(TAG_POOL_ARRAY);
+	put_u8(p_type);
+	put_u32(length);
+	put_bytes(r.ptr(), length);
+}
+
+void DuktapeMessage::put_variant(const Variant &p_value) {
+	switch (p_value.get_type()) {
+		case Variant::NIL:
+			put_u8(TAG_NULL);
+			break;
+		case Variant::BOOL:
+			put_u8(bool(p_value) ? TAG_TRUE : TAG_FALSE);
+			break;
+		case Variant::INT: {
+			const int64_t num = p_value;
+			if (num == int64_t(int32_t(num))) {
+				put_u8(TAG_INT);
+				put_u32(uint32_t(int32_t(num)));
+			} else {
+				put_u8(TAG_DOUBLE);
+				encode_double(double(num), reserve(8));
+			}
+		} break;
+		case Variant::REAL:
+			put_u8(TAG_DOUBLE);
+			encode_double(double(p_value), reserve(8));
+			break;
+		case Variant::STRING:
+		case Variant::NODE_PATH: {
+			const CharString utf8 = String(p_value).utf8();
+			put_string(utf8.get_data(), utf8.length());
+		} break;
+		case Variant::ARRAY: {
+			const Array arr = p_value;
+			put_u8(TAG_ARRAY);
+			put_u32(arr.size());
+			for (int i = 0; i < arr.size(); ++i) {
+				put_variant(arr[i]);
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			const Dictionary dict = p_value;
+			put_u8(TAG_OBJECT);
+			put_u32(dict.size());
+			for (const Variant *key = dict.next(NULL); key; key = dict.next(key)) {
+				const CharString utf8 = String(*key).utf8();
+				put_u32(utf8.length());
+				put_bytes(utf8.get_data(), utf8.length());
+				put_variant(dict[*key]);
+			}
+		} break;
+		case Variant::POOL_BYTE_ARRAY:
+			put_pool_data<PoolByteArray>(Variant::POOL_BYTE_ARRAY, p_value);
+			break;
+		case Variant::POOL_INT_ARRAY:
+			put_pool_data<PoolIntArray>(Variant::POOL_INT_ARRAY, p_value);
+			break;
+		case Variant::POOL_REAL_ARRAY:
+			put_pool_data<PoolRealArray>(Variant::POOL_REAL_ARRAY, p_value);
+			break;
+		case Variant::POOL_VECTOR2_ARRAY:
+			put_pool_data<PoolVector2Array>(Variant::POOL_VECTOR2_ARRAY, p_value);
+			break;
+		case Variant::POOL_VECTOR3_ARRAY:
+			put_pool_data<PoolVector3Array>(Variant::POOL_VECTOR3_ARRAY, p_value);
+			break;
+		case Variant::POOL_COLOR_ARRAY:
+			put_pool_data<PoolColorArray>(Variant::POOL_COLOR_ARRAY, p_value);
+			break;
+		case Variant::POOL_STRING_ARRAY: {
+			const PoolStringArray arr = p_value;
+			PoolStringArray::Read r = arr.read();
+			put_u8(TAG_ARRAY);
+			put_u32(arr.size());
+			for (int i = 0; i < arr.size(); ++i) {
+				const CharString utf8 = r[i].utf8();
+				put_string(utf8.get_data(), utf8.length());
+			}
+		} break;
+		case Variant::OBJECT:
+		case Variant::_RID:
+			WARN_PRINTS(Variant::get_type_name(p_value.get_type()) + " could not be cloned and is replaced by null");
+			put_u8(TAG_NULL);
+			break;
+		default: {
+			int length = 0;
+			::encode_variant(p_value, NULL, length);
+			put_u8(TAG_VARIANT);
+			put_u32(length);
+			::encode_variant(p_value, reserve(length), length);
+		} break;
+	}
+}
+
+bool DuktapeMessage::encode(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx) {
+	idx = duk_normalize_index(ctx, idx);
+	if (transfer_idx != DUK_INVALID_INDEX) {
+		transfer_idx = duk_normalize_index(ctx, transfer_idx);
+	}
+	const duk_idx_t top = duk_get_top(ctx);
+	Vector<const void *> parents;
+	pending_transfers.clear();
+	if (!put_value(ctx, idx, transfer_idx, parents)) {
+		pending_transfers.clear();
+		// Keep only the error on the value stack
+		if (duk_get_top(ctx) > top + 1) {
+			duk_replace(ctx, top);
+			duk_set_top(ctx, top + 1);
+		}
+		return false;
+	}
+
+	for (int i = 0; i < pending_transfers.size(); ++i) {
+		const int index = pending_transfers[i];
+		if (transfers.size() <= index) {
+			transfers.resize(index + 1);
+		}
+		duk_get_prop_index(ctx, transfer_idx, index);
+		transfers.ptrw()[index] = take_transferable(ctx, -1);
+		duk_pop(ctx);
+	}
+	pending_transfers.clear();
+	return true;
+}
+
+void DuktapeMessage::encode_variant(const Variant &p_value) {
+	put_variant(p_value);
+}
+
+bool DuktapeMessage::get_u32(int &r_pos, uint32_t &r_value) const {
+	ERR_FAIL_COND_V(r_pos + 4 > data.size(), false);
+	r_value = decode_uint32(data.ptr() + r_pos);
+	r_pos += 4;
+	return true;
+}
+
+template <class E>
+static Variant pool_array_from_bytes(const uint8_t *p_data, uint32_t p_length) {
+	PoolVector<E> arr;
+	arr.resize(p_length / sizeof(E));
+	typename PoolVector<E>::Write w = arr.write();
+	copymem(w.ptr(), p_data, arr.size() * sizeof(E));
+	return arr;
+}
+
+template <class E, class T>
+static Variant pool_array_from_elements(const uint8_t *p_data, uint32_t p_length) {
+	PoolVector<E> arr;
+	arr.resize(p_length / sizeof(T));
+	typename PoolVector<E>::Write w = arr.write();
+	for (int i = 0; i < arr.size(); ++i) {
+		T value;
+		copymem(&value, p_data + i * sizeof(T), sizeof(T));
+		w[i] = E(value);
+	}
+	return arr;
+}
+
+static Variant pool_array_from_pool_data(uint8_t p_type, const uint8_t *p_data, uint32_t p_length) {
+	switch (p_type) {
+		case Variant::POOL_BYTE_ARRAY:
+			return pool_array_from_bytes<uint8_t>(p_data, p_length);
+		case Variant::POOL_INT_ARRAY:
+			return pool_array_from_bytes<int>(p_data, p_length);
+		case Variant::POOL_REAL_ARRAY:
+			return pool_array_from_bytes<real_t>(p_data, p_length);
+		case Variant::POOL_VECTOR2_ARRAY:
+			return pool_array_from_bytes<Vector2>(p_data, p_length);
+		case Variant::POOL_VECTOR3_ARRAY:
+			return pool_array_from_bytes<Vector3>(p_data, p_length);
+		case Variant::POOL_COLOR_ARRAY:
+			return pool_array_from_bytes<Color>(p_data, p_length);
+		default:
+			return Variant();
+	}
+}
+
+static Variant pool_array_from_buffer_data(uint8_t p_type, const uint8_t *p_data, uint32_t p_length) {
+	switch (p_type) {
+		case DUK_BUFOBJ_INT8ARRAY:
+			return pool_array_from_elements<int, int8_t>(p_data, p_length);
+		case DUK_BUFOBJ_INT16ARRAY:
+			return pool_array_from_elements<int, int16_t>(p_data, p_length);
+		case DUK_BUFOBJ_UINT16ARRAY:
+			return pool_array_from_elements<int, uint16_t>(p_data, p_length);
+		case DUK_BUFOBJ_INT32ARRAY:
+		case DUK_BUFOBJ_UINT32ARRAY:
+			return pool_array_from_bytes<int>(p_data, p_length);
+		case DUK_BUFOBJ_FLOAT32ARRAY:
+			return pool_array_from_elements<real_t, float>(p_data, p_length);
+		case DUK_BUFOBJ_FLOAT64ARRAY:
+			return pool_array_from_elements<real_t, double>(p_data, p_length);
+		default:
+			return pool_array_from_bytes<uint8_t>(p_data, p_length);
+	}
+}
+
+bool DuktapeMessage::push_value(duk_context *ctx, int &r_pos, bool p_engine_types, Vector<void *> &r_transferred) {
+	ERR_FAIL_COND_V(r_pos >= data.size(), false);
+	duk_require_stack(ctx, 4);
+
+	const uint8_t *ptr = data.ptr();
+	uint32_t length = 0;
+	switch (ptr[r_pos++]) {
+		case TAG_UNDEFINED:
+			duk_push_undefined(ctx);
+			break;
+		case TAG_NULL:
+			duk_push_null(ctx);
+			break;
+		case TAG_FALSE:
+			duk_push_false(ctx);
+			break;
+		case TAG_TRUE:
+			duk_push_true(ctx);
+			break;
+		case TAG_INT: {
+			uint32_t num = 0;
+			if (!get_u32(r_pos, num)) return false;
+			duk_push_int(ctx, int32_t(num));
+		} break;
+		case TAG_DOUBLE:
+			ERR_FAIL_COND_V(r_pos + 8 > data.size(), false);
+			duk_push_number(ctx, decode_double(ptr + r_pos));
+			r_pos += 8;
+			break;
+		case TAG_STRING:
+			if (!get_u32(r_pos, length)) return false;
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), false);
+			duk_push_lstring(ctx, reinterpret_cast<const char *>(ptr + r_pos), length);
+			r_pos += length;
+			break;
+		case TAG_ARRAY:
+			if (!get_u32(r_pos, length)) return false;
+			duk_push_array(ctx);
+			for (uint32_t i = 0; i < length; ++i) {
+				if (!push_value(ctx, r_pos, p_engine_types, r_transferred)) return false;
+				duk_put_prop_index(ctx, -2, i);
+			}
+			break;
+		case TAG_OBJECT:
+			if (!get_u32(r_pos, length)) return false;
+			duk_push_object(ctx);
+			for (uint32_t i = 0; i < length; ++i) {
+				uint32_t key_length = 0;
+				if (!get_u32(r_pos, key_length)) return false;
+				ERR_FAIL_COND_V(r_pos + key_length > uint32_t(data.size()), false);
+				duk_push_lstring(ctx, reinterpret_cast<const char *>(ptr + r_pos), key_length);
+				r_pos += key_length;
+				if (!push_value(ctx, r_pos, p_engine_types, r_transferred)) return false;
+				duk_put_prop(ctx, -3);
+			}
+			break;
+		case TAG_BUFFER:
+		case TAG_POOL_ARRAY: {
+			const bool is_pool = ptr[r_pos - 1] == TAG_POOL_ARRAY;
+			ERR_FAIL_COND_V(r_pos >= data.size(), false);
+			const uint8_t type = ptr[r_pos++];
+			if (!get_u32(r_pos, length)) return false;
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), false);
+			if (is_pool && p_engine_types) {
+				DuktapeBindingHelper::duk_push_godot_variant(ctx, pool_array_from_pool_data(type, ptr + r_pos, length));
+			} else {
+				void *buffer = duk_push_fixed_buffer(ctx, length);
+				if (length > 0) {
+					copymem(buffer, ptr + r_pos, length);
+				}
+				duk_push_buffer_object(ctx, -1, 0, length, is_pool ? DuktapeBindingHelper::get_pool_array_view_type(Variant::Type(type)) : type);
+				duk_remove(ctx, -2);
+			}
+			r_pos += length;
+		} break;
+		case TAG_TRANSFER: {
+			uint32_t index = 0;
+			if (!get_u32(r_pos, index)) return false;
+			ERR_FAIL_COND_V(index >= uint32_t(transfers.size()), false);
+			if (r_transferred[index]) {
+				// the same transferable again, it is still referenced by the value being built
+				duk_push_heapptr(ctx, r_transferred[index]);
+				break;
+			}
+			// The storage moves to the receiver, the message keeps nothing
+			Variant array = transfers[index];
+			transfers.ptrw()[index] = Variant();
+			if (p_engine_types) {
+				DuktapeBindingHelper::duk_push_godot_variant(ctx, array);
+			} else {
+				DuktapeBindingHelper::duk_push_pool_array_view(ctx, array);
+			}
+			r_transferred.ptrw()[index] = duk_get_heapptr(ctx, -1);
+		} break;
+		case TAG_VARIANT: {
+			if (!get_u32(r_pos, length)) return false;
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), false);
+			Variant value;
+			if (p_engine_types && ::decode_variant(value, ptr + r_pos, length) == OK) {
+				DuktapeBindingHelper::duk_push_godot_variant(ctx, value);
+			} else {
+				duk_push_null(ctx);
+			}
+			r_pos += length;
+		} break;
+		default:
+			ERR_FAIL_V(false);
+	}
+	return true;
+}
+
+void DuktapeMessage::decode(duk_context *ctx, bool p_engine_types) {
+	const duk_idx_t top = duk_get_top(ctx);
+	int pos = 0;
+	Vector<void *> transferred;
+	transferred.resize(transfers.size());
+	for (int i = 0; i < transferred.size(); ++i) {
+		transferred.ptrw()[i] = NULL;
+	}
+	if (!push_value(ctx, pos, p_engine_types, transferred)) {
+		duk_set_top(ctx, top);
+		duk_push_undefined(ctx);
+	}
+}
+
+Variant DuktapeMessage::get_variant(int &r_pos) const {
+	ERR_FAIL_COND_V(r_pos >= data.size(), Variant());
+
+	const uint8_t *ptr = data.ptr();
+	uint32_t length = 0;
+	switch (ptr[r_pos++]) {
+		case TAG_UNDEFINED:
+		case TAG_NULL:
+			return Variant();
+		case TAG_FALSE:
+			return false;
+		case TAG_TRUE:
+			return true;
+		case TAG_INT: {
+			uint32_t num = 0;
+			if (!get_u32(r_pos, num)) return Variant();
+			return int32_t(num);
+		}
+		case TAG_DOUBLE: {
+			ERR_FAIL_COND_V(r_pos + 8 > data.size(), Variant());
+			const double num = decode_double(ptr + r_pos);
+			r_pos += 8;
+			return num;
+		}
+		case TAG_STRING: {
+			if (!get_u32(r_pos, length)) return Variant();
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), Variant());
+			String str;
+			str.parse_utf8(reinterpret_cast<const char *>(ptr + r_pos), length);
+			r_pos += length;
+			return str;
+		}
+		case TAG_ARRAY: {
+			if (!get_u32(r_pos, length)) return Variant();
+			Array arr;
+			arr.resize(length);
+			for (uint32_t i = 0; i < length; ++i) {
+				arr[i] = get_variant(r_pos);
+			}
+			return arr;
+		}
+		case TAG_OBJECT: {
+			if (!get_u32(r_pos, length)) return Variant();
+			Dictionary dict;
+			for (uint32_t i = 0; i < length; ++i) {
+				uint32_t key_length = 0;
+				if (!get_u32(r_pos, key_length)) return dict;
+				ERR_FAIL_COND_V(r_pos + key_length > uint32_t(data.size()), dict);
+				String key;
+				key.parse_utf8(reinterpret_cast<const char *>(ptr + r_pos), key_length);
+				r_pos += key_length;
+				dict[key] = get_variant(r_pos);
+			}
+			return dict;
+		}
+		case TAG_BUFFER:
+		case TAG_POOL_ARRAY: {
+			const bool is_pool = ptr[r_pos - 1] == TAG_POOL_ARRAY;
+			ERR_FAIL_COND_V(r_pos >= data.size(), Variant());
+			const uint8_t type = ptr[r_pos++];
+			if (!get_u32(r_pos, length)) return Variant();
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), Variant());
+			const Variant arr = is_pool ? pool_array_from_pool_data(type, ptr + r_pos, length) : pool_array_from_buffer_data(type, ptr + r_pos, length);
+			r_pos += length;
+			return arr;
+		}
+		case TAG_TRANSFER: {
+			uint32_t index = 0;
+			if (!get_u32(r_pos, index)) return Variant();
+			ERR_FAIL_COND_V(index >= uint32_t(transfers.size()), Variant());
+			return transfers[index];
+		}
+		case TAG_VARIANT: {
+			if (!get_u32(r_pos, length)) return Variant();
+			ERR_FAIL_COND_V(r_pos + length > uint32_t(data.size()), Variant());
+			Variant value;
+			::decode_variant(value, ptr + r_pos, length);
+			r_pos += length;
+			return value;
+		}
+		default:
+			ERR_FAIL_V(Variant());
+	}
+}
+
+Variant DuktapeMessage::decode_variant() {
+	int pos = 0;
+	const Variant ret = get_variant(pos);
+	transfers.clear();
+	return ret;
+}
+
+bool DuktapeBindingHelper::structured_clone(duk_context *ctx) {
+	DuktapeMessage message;
+	if (!message.encode(ctx, 0, duk_is_array(ctx, 1) ? 1 : DUK_INVALID_INDEX)) {
+		return false;
+	}
+	message.decode(ctx, true);
+	return true;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_structured_clone(duk_context *ctx) {
+	// Errors are thrown from here where the message is already released
+	if (!structured_clone(ctx)) {
+		return duk_throw(ctx);
+	}
+	return DUK_HAS_RET_VAL;
+}
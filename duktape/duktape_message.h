@@ -0,0 +1,76 @@
+#ifndef DUKTAPE_MESSAGE_H
+#define DUKTAPE_MESSAGE_H
+
+#include "core/variant.h"
+#include "core/vector.h"
+#include "src/duktape.h"
+
+/**
+ * Structured clone of a value sent from one Duktape heap to another.
+ *
+ * The value is serialized to a compact tagged binary format straight from the value stack, or from a Variant,
+ * and rebuilt in the receiving heap without an intermediate Variant tree. Typed arrays are copied in bulk.
+ *
+ * Pool arrays and their TypedArray views listed as transferables are moved instead of copied: their storage
+ * is handed over with the message and the sender is left with an empty array or a detached view. They are only
+ * taken from the sender once the whole value is encoded, a message that fails to encode leaves them untouched.
+ */
+class DuktapeMessage {
+public:
+	enum Tag {
+		TAG_UNDEFINED,
+		TAG_NULL,
+		TAG_FALSE,
+		TAG_TRUE,
+		TAG_INT, // int32
+		TAG_DOUBLE,
+		TAG_STRING, // uint32 byte length, UTF-8 bytes
+		TAG_ARRAY, // uint32 length, values
+		TAG_OBJECT, // uint32 count, (string, value) pairs
+		TAG_BUFFER, // uint8 buffer object type, uint32 byte length, bytes
+		TAG_POOL_ARRAY, // uint8 Variant type, uint32 byte length, bytes
+		TAG_TRANSFER, // uint32 index of a moved pool array
+		TAG_VARIANT, // uint32 byte length, other engine values in encode_variant format
+	};
+
+private:
+	Vector<uint8_t> data;
+	Vector<Variant> transfers;
+	Vector<int> pending_transfers; // positions in the transfer list of the value being encoded, taken once it succeeded
+
+	uint8_t *reserve(int p_size);
+	void put_u8(uint8_t p_value);
+	void put_u32(uint32_t p_value);
+	void put_bytes(const void *p_data, int p_size);
+	void put_string(const char *p_str, int p_length);
+	template <class T>
+	void put_pool_data(Variant::Type p_type, const T &p_array);
+
+	bool put_value(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx, Vector<const void *> &r_parents);
+	bool put_transfer(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx, bool &r_transferred);
+	static Variant take_transferable(duk_context *ctx, duk_idx_t idx);
+	void put_variant(const Variant &p_value);
+
+	bool get_u32(int &r_pos, uint32_t &r_value) const;
+	bool push_value(duk_context *ctx, int &r_pos, bool p_engine_types, Vector<void *> &r_transferred);
+	Variant get_variant(int &r_pos) const;
+
+public:
+	/**
+	 * Serializes the value at idx, transfer_idx is an optional array of transferables.
+	 * Returns false with an error on the value stack when the value can't be cloned.
+	 */
+	bool encode(duk_context *ctx, duk_idx_t idx, duk_idx_t transfer_idx = DUK_INVALID_INDEX);
+	void encode_variant(const Variant &p_value);
+
+	/**
+	 * Pushes the value to the receiving heap. Heaps with engine types get pool arrays and builtin values,
+	 * other heaps get TypedArray views and null for engine values. Transferred arrays are consumed.
+	 */
+	void decode(duk_context *ctx, bool p_engine_types);
+	Variant decode_variant();
+
+	_FORCE_INLINE_ int get_size() const { return data.size(); }
+};
+
+#endif // DUKTAPE_MESSAGE_H
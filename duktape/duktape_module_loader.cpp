@@ -0,0 +1,227 @@
+#include "../ecmascript_library.h"
+#include "core/engine.h"
+#include "core/os/file_access.h"
+#include "core/project_settings.h"
+#include "duktape_binding_helper.h"
+
+/**
+ * CommonJS modules.
+ *
+ * `require(id)` resolves `id` to a file path and evaluates the file once, the module object is kept in the
+ * registry of the heap stash and later calls return the same exports. A module is compiled as a function
+ * taking `exports, require, module, __filename, __dirname` so its top level variables stay private.
+ *
+ * Ids starting with `res://` or `user://` are absolute, `./` and `../` are relative to the requiring module
+ * and other ids are relative to `res://`. The `.js` extension and `/index.js` are tried when the path itself
+ * is not a file.
+ *
+ * Libraries are compiled with the same wrapper and run as the module of their path, so their `require` is
+ * relative to them as well.
+ */
+
+#define MODULE_WRAPPER_HEAD "(function (exports, require, module, __filename, __dirname) {"
+#define MODULE_WRAPPER_TAIL "\n})"
+
+String DuktapeBindingHelper::resolve_module_path(const String &p_dirname, const String &p_id) {
+
+	String path;
+	if (p_id.begins_with("res://") || p_id.begins_with("user://")) {
+		path = p_id;
+	} else if (p_id.begins_with("./") || p_id.begins_with("../")) {
+		path = p_dirname.plus_file(p_id);
+	} else {
+		path = String("res://").plus_file(p_id);
+	}
+	path = path.simplify_path();
+
+	if (path.get_extension() == "js" && FileAccess::exists(path)) {
+		return path;
+	}
+	if (FileAccess::exists(path + ".js")) {
+		return path + ".js";
+	}
+	if (FileAccess::exists(path.plus_file("index.js"))) {
+		return path.plus_file("index.js");
+	}
+	return String();
+}
+
+String DuktapeBindingHelper::wrap_module_source(const String &p_source) {
+	// The head has no line break so line numbers of errors match the file
+	return MODULE_WRAPPER_HEAD + p_source + MODULE_WRAPPER_TAIL;
+}
+
+void DuktapeBindingHelper::duk_push_require_function(duk_context *ctx, const String &p_dirname) {
+	duk_push_c_function(ctx, godot_require, 1);
+	duk_push_godot_string(ctx, p_dirname);
+	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("dirname"));
+}
+
+bool DuktapeBindingHelper::duk_push_module_function(duk_context *ctx, const String &p_path) {
+
+	Error err;
+	const String source = FileAccess::get_file_as_string(p_path, &err);
+	if (err != OK) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot read module '%s'", p_path.utf8().get_data());
+		return false;
+	}
+	const String wrapped_source = wrap_module_source(source);
+
+	// Compiled modules share the bytecode cache of libraries under their own key
+	const bool use_cache = !Engine::get_singleton()->is_editor_hint() && GLOBAL_GET("ecmascript/bytecode_cache");
+	const String cache_path = ECMAScriptLibrary::get_bytecode_cache_path("module:" + p_path);
+
+	Vector<uint8_t> bytecode;
+	bool compiled = false;
+	if (use_cache && OK == ECMAScriptLibrary::load_bytecode(cache_path, wrapped_source, bytecode)) {
+		void *buffer = duk_push_fixed_buffer(ctx, bytecode.size());
+		copymem(buffer, bytecode.ptr(), bytecode.size());
+		compiled = DUK_EXEC_SUCCESS == duk_safe_call(ctx, safe_load_function, NULL, 1, 1);
+		if (!compiled) {
+			duk_pop(ctx);
+		}
+	}
+
+	if (!compiled) {
+		duk_push_godot_string(ctx, wrapped_source);
+		duk_push_godot_string(ctx, p_path);
+		if (DUK_EXEC_SUCCESS != duk_pcompile(ctx, DUK_COMPILE_EVAL)) {
+			return false;
+		}
+		if (use_cache) {
+			duk_dup_top(ctx);
+			duk_dump_function(ctx);
+			duk_size_t size = 0;
+			const void *data = duk_get_buffer(ctx, -1, &size);
+			bytecode.resize(size);
+			copymem(bytecode.ptrw(), data, size);
+			duk_pop(ctx);
+			if (OK != ECMAScriptLibrary::save_bytecode(cache_path, wrapped_source, bytecode)) {
+				WARN_PRINTS("Failed to write the bytecode cache of " + p_path);
+			}
+		}
+	}
+
+	// The compiled program evaluates to the module function
+	return DUK_EXEC_SUCCESS == duk_pcall(ctx, 0);
+}
+
+bool DuktapeBindingHelper::require_module(duk_context *ctx) {
+
+	DuktapeBindingHelper *self = get_singleton();
+	if (!duk_is_string(ctx, 0)) {
+		duk_push_error_object(ctx, DUK_ERR_TYPE_ERROR, "Module id must be a string");
+		return false;
+	}
+	const String id = duk_get_godot_string(ctx, 0);
+
+	duk_push_current_function(ctx);
+	duk_get_prop_literal(ctx, -1, DUK_HIDDEN_SYMBOL("dirname"));
+	const String dirname = duk_get_godot_string(ctx, -1);
+	duk_pop_2(ctx);
+
+	const String path = resolve_module_path(dirname, id);
+	if (path.empty()) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot find module '%s'", id.utf8().get_data());
+		return false;
+	}
+
+	duk_push_heapptr(ctx, self->module_registry_ptr);
+	duk_push_godot_string(ctx, path);
+	if (duk_get_prop(ctx, -2)) {
+		duk_get_prop_literal(ctx, -1, "exports");
+		return true;
+	}
+	duk_pop_2(ctx);
+
+	if (!duk_push_module_function(ctx, path)) {
+		return false;
+	}
+	return duk_call_module_function(ctx, path);
+}
+
+bool DuktapeBindingHelper::duk_call_module_function(duk_context *ctx, const String &p_path) {
+
+	const duk_idx_t function_idx = duk_get_top_index(ctx);
+	duk_push_heapptr(ctx, get_singleton()->module_registry_ptr);
+	const duk_idx_t registry_idx = duk_get_top_index(ctx);
+	const String &path = p_path;
+
+	duk_push_object(ctx);
+	const duk_idx_t module_idx = duk_get_top_index(ctx);
+	duk_push_object(ctx);
+	duk_put_prop_literal(ctx, module_idx, "exports");
+	duk_push_godot_string(ctx, path);
+	duk_put_prop_literal(ctx, module_idx, "id");
+	duk_push_godot_string(ctx, path);
+	duk_put_prop_literal(ctx, module_idx, "filename");
+	duk_push_false(ctx);
+	duk_put_prop_literal(ctx, module_idx, "loaded");
+
+	// Registered before it runs so circular requires get the exports defined so far
+	duk_push_godot_string(ctx, path);
+	duk_dup(ctx, module_idx);
+	duk_put_prop(ctx, registry_idx);
+
+	// module_function.call(module.exports, module.exports, require, module, __filename, __dirname)
+	duk_dup(ctx, function_idx);
+	duk_get_prop_literal(ctx, module_idx, "exports");
+	duk_dup_top(ctx);
+	duk_push_require_function(ctx, path.get_base_dir());
+	duk_dup(ctx, module_idx);
+	duk_push_godot_string(ctx, path);
+	duk_push_godot_string(ctx, path.get_base_dir());
+	if (DUK_EXEC_SUCCESS != duk_pcall_method(ctx, 5)) {
+		// A failed module can be required again
+		duk_push_godot_string(ctx, path);
+		duk_del_prop(ctx, registry_idx);
+		duk_replace(ctx, function_idx);
+		duk_set_top(ctx, function_idx + 1);
+		return false;
+	}
+	duk_pop(ctx);
+
+	duk_push_true(ctx);
+	duk_put_prop_literal(ctx, module_idx, "loaded");
+	duk_get_prop_literal(ctx, module_idx, "exports");
+	duk_replace(ctx, function_idx);
+	duk_set_top(ctx, function_idx + 1);
+	return true;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_require(duk_context *ctx) {
+	// Errors are thrown from here where no engine objects are alive on the native stack
+	if (!require_module(ctx)) {
+		return duk_throw(ctx);
+	}
+	return DUK_HAS_RET_VAL;
+}
+
+void DuktapeBindingHelper::register_module_loader(duk_context *ctx) {
+	// registry of loaded modules keyed by file path
+	duk_push_heap_stash(ctx);
+	duk_push_object(ctx);
+	module_registry_ptr = duk_get_heapptr(ctx, -1);
+	duk_put_prop_literal(ctx, -2, "modules");
+	duk_pop(ctx);
+
+	duk_push_global_object(ctx);
+	duk_push_literal(ctx, "require");
+	duk_push_require_function(ctx, "res://");
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+	duk_pop(ctx);
+}
+
+void DuktapeBindingHelper::clear_classes() {
+	ECMAScriptBindingHelper::clear_classes();
+
+	// Modules are evaluated again after the classes are reloaded
+	if (ctx) {
+		HeapLock lock(this);
+		duk_push_heap_stash(ctx);
+		duk_push_object(ctx);
+		module_registry_ptr = duk_get_heapptr(ctx, -1);
+		duk_put_prop_literal(ctx, -2, "modules");
+		duk_pop(ctx);
+	}
+}
@@ -0,0 +1,103 @@
+#include "duktape_payload_pool.h"
+#include "duktape_binding_helper.h"
+
+void DuktapePayloadPool::refill(int p_size_class) {
+
+	const size_t slot_size = (p_size_class + 1) * SIZE_CLASS_GRANULARITY;
+
+	// The first slot of a chunk links it into the chunk list
+	uint8_t *chunk = static_cast<uint8_t *>(memalloc(sizeof(FreeSlot) + slot_size * SLOTS_PER_CHUNK));
+	ERR_FAIL_NULL(chunk);
+	FreeSlot *header = reinterpret_cast<FreeSlot *>(chunk);
+	header->next = chunks;
+	chunks = header;
+
+	uint8_t *slots = chunk + sizeof(FreeSlot);
+	for (int i = SLOTS_PER_CHUNK - 1; i >= 0; --i) {
+		FreeSlot *slot = reinterpret_cast<FreeSlot *>(slots + i * slot_size);
+		slot->next = free_lists[p_size_class];
+		free_lists[p_size_class] = slot;
+	}
+}
+
+void *DuktapePayloadPool::alloc(size_t p_size, Variant::Type p_type) {
+
+	// Every create() ends up here, builtin constructors as well as values and containers passed from the engine
+	ECMASCRIPT_STATS_INCREMENT(payload_allocations);
+	Stats &s = stats[p_type];
+	s.allocated++;
+	s.live++;
+
+	const int size_class = get_size_class(p_size);
+	if (size_class >= SIZE_CLASS_COUNT) {
+		return memalloc(p_size);
+	}
+
+	if (free_lists[size_class]) {
+		s.recycled++;
+	} else {
+		refill(size_class);
+		ERR_FAIL_NULL_V(free_lists[size_class], NULL);
+	}
+
+	FreeSlot *slot = free_lists[size_class];
+	free_lists[size_class] = slot->next;
+	return slot;
+}
+
+void DuktapePayloadPool::free(void *p_ptr, size_t p_size, Variant::Type p_type) {
+	ERR_FAIL_NULL(p_ptr);
+
+	stats[p_type].live--;
+
+	const int size_class = get_size_class(p_size);
+	if (size_class >= SIZE_CLASS_COUNT) {
+		memfree(p_ptr);
+		return;
+	}
+
+	FreeSlot *slot = static_cast<FreeSlot *>(p_ptr);
+	slot->next = free_lists[size_class];
+	free_lists[size_class] = slot;
+}
+
+Dictionary DuktapePayloadPool::get_stats_dictionary() const {
+	Dictionary ret;
+	for (int i = 0; i < Variant::VARIANT_MAX; ++i) {
+		const Stats &s = stats[i];
+		if (s.allocated == 0) continue;
+		Dictionary item;
+		item["live"] = s.live;
+		item["recycled"] = s.recycled;
+		item["allocated"] = s.allocated;
+		ret[Variant::get_type_name(Variant::Type(i))] = item;
+	}
+	return ret;
+}
+
+void DuktapePayloadPool::clear() {
+
+	while (chunks) {
+		FreeSlot *next = chunks->next;
+		memfree(chunks);
+		chunks = next;
+	}
+
+	for (int i = 0; i < SIZE_CLASS_COUNT; ++i) {
+		free_lists[i] = NULL;
+	}
+	for (int i = 0; i < Variant::VARIANT_MAX; ++i) {
+		stats[i].allocated = 0;
+		stats[i].recycled = 0;
+		stats[i].live = 0;
+	}
+}
+
+DuktapePayloadPool::DuktapePayloadPool() {
+	chunks = NULL;
+	clear();
+}
+
+DuktapePayloadPool::~DuktapePayloadPool() {
+	clear();
+}
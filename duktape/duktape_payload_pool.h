@@ -0,0 +1,64 @@
+#ifndef DUKTAPE_PAYLOAD_POOL_H
+#define DUKTAPE_PAYLOAD_POOL_H
+
+#include "core/os/memory.h"
+#include "core/variant.h"
+
+/**
+ * Size-class pool for the native payloads of builtin value wrappers (Vector2, Color, Transform ...).
+ * Released payloads are kept in a free list of their size class and handed out again by the next
+ * allocation of that class, so the wrapper churn of per-frame math does not reach the system allocator.
+ */
+class DuktapePayloadPool {
+public:
+	struct Stats {
+		uint64_t allocated; // payloads handed out since the pool was created
+		uint64_t recycled; // payloads handed out from a free list
+		uint32_t live; // payloads currently held by wrapper objects
+	};
+
+private:
+	enum {
+		SIZE_CLASS_GRANULARITY = 16,
+		SIZE_CLASS_COUNT = 4, // 16, 32, 48 and 64 bytes, larger payloads use memalloc directly
+		SLOTS_PER_CHUNK = 128,
+	};
+
+	union FreeSlot {
+		FreeSlot *next;
+		uint8_t align[SIZE_CLASS_GRANULARITY];
+	};
+
+	FreeSlot *free_lists[SIZE_CLASS_COUNT];
+	FreeSlot *chunks;
+	Stats stats[Variant::VARIANT_MAX];
+
+	static _FORCE_INLINE_ int get_size_class(size_t p_size) { return int((p_size - 1) / SIZE_CLASS_GRANULARITY); }
+	void refill(int p_size_class);
+
+public:
+	void *alloc(size_t p_size, Variant::Type p_type);
+	void free(void *p_ptr, size_t p_size, Variant::Type p_type);
+
+	template <class T>
+	_FORCE_INLINE_ T *create(Variant::Type p_type, const T &p_value) {
+		return memnew_placement(alloc(sizeof(T), p_type), T(p_value));
+	}
+
+	template <class T>
+	_FORCE_INLINE_ void destroy(Variant::Type p_type, T *p_ptr) {
+		p_ptr->~T();
+		free(p_ptr, sizeof(T), p_type);
+	}
+
+	_FORCE_INLINE_ const Stats &get_stats(Variant::Type p_type) const { return stats[p_type]; }
+	Dictionary get_stats_dictionary() const;
+
+	// Releases every chunk, all payloads must have been freed before
+	void clear();
+
+	DuktapePayloadPool();
+	~DuktapePayloadPool();
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "duktape_profiler.h"
+#include "core/os/os.h"
+
+int DuktapeProfiler::get_function(const void *p_ptr, const char *p_name, const char *p_file_name, duk_int_t p_line) {
+	if (const CachedFunction *cached = function_cache.getptr(p_ptr)) {
+		if (cached->name == p_name && cached->file_name == p_file_name && cached->line == p_line) {
+			return cached->index;
+		}
+	}
+
+	// Signatures are parsed by the editor as file::line::name
+	const String signature = String::utf8(p_file_name) + "::" + itos(p_line) + "::" + (p_name && *p_name ? String::utf8(p_name) : String("<anonymous>"));
+	int index;
+	if (const int *existing = function_indices.getptr(signature)) {
+		index = *existing;
+	} else {
+		Function function = {};
+		function.signature = signature;
+		index = functions.size();
+		functions.push_back(function);
+		function_indices.set(signature, index);
+	}
+
+	const CachedFunction cached = { p_name, p_file_name, p_line, index };
+	function_cache.set(p_ptr, cached);
+	return index;
+}
+
+void DuktapeProfiler::interrupt_hook(void *udata, duk_context *ctx) {
+	static_cast<DuktapeProfiler *>(udata)->sample(ctx);
+}
+
+void DuktapeProfiler::sample(duk_context *ctx) {
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	const uint64_t elapsed = now - last_sample_usec;
+	last_sample_usec = now;
+	++sample_count;
+
+	bool running = true;
+	for (duk_int_t level = -1; level >= -MAX_SAMPLE_DEPTH; --level) {
+		const char *name;
+		const char *file_name;
+		duk_int_t line;
+		const void *ptr = duk_get_callstack_function_info(ctx, level, &name, &file_name, &line);
+		if (NULL == ptr) break;
+		// Native functions have no source to show
+		if (NULL == file_name) continue;
+
+		const int index = get_function(ptr, name, file_name, line);
+		Function &function = functions.ptrw()[index];
+		if (running) {
+			function.self_time += elapsed;
+			function.frame_self_time += elapsed;
+			running = false;
+		}
+		if (function.last_sample != sample_count) {
+			function.last_sample = sample_count;
+			function.sampled_total_time += elapsed;
+			function.frame_sampled_total_time += elapsed;
+		}
+	}
+}
+
+void DuktapeProfiler::start(duk_context *ctx, int p_sample_interval) {
+	functions.clear();
+	function_indices.clear();
+	function_cache.clear();
+	sample_count = 0;
+	call_depth = 0;
+	last_sample_usec = OS::get_singleton()->get_ticks_usec();
+	active = true;
+	duk_set_interrupt_hook(ctx, interrupt_hook, this, p_sample_interval);
+}
+
+void DuktapeProfiler::stop(duk_context *ctx) {
+	if (!active) return;
+	duk_set_interrupt_hook(ctx, NULL, NULL, 0);
+	active = false;
+}
+
+int DuktapeProfiler::begin_call(duk_context *ctx, duk_idx_t p_func_idx, uint64_t &r_start_usec) {
+	r_start_usec = OS::get_singleton()->get_ticks_usec();
+	// Time spent outside of scripts isn't sampled
+	if (call_depth++ == 0) {
+		last_sample_usec = r_start_usec;
+	}
+
+	const char *name;
+	const char *file_name;
+	duk_int_t line;
+	const void *ptr = duk_get_function_info(ctx, p_func_idx, &name, &file_name, &line);
+	if (NULL == ptr || NULL == file_name) return -1;
+	return get_function(ptr, name, file_name, line);
+}
+
+void DuktapeProfiler::end_call(int p_function, uint64_t p_start_usec) {
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	const bool outermost = --call_depth == 0;
+	if (p_function < 0) return;
+
+	Function &function = functions.ptrw()[p_function];
+	function.call_count++;
+	function.frame_call_count++;
+	function.total_time += now - p_start_usec;
+	function.frame_total_time += now - p_start_usec;
+	if (outermost) {
+		// The time since the last sample belongs to the returning function
+		function.self_time += now - last_sample_usec;
+		function.frame_self_time += now - last_sample_usec;
+		last_sample_usec = now;
+	}
+}
+
+void DuktapeProfiler::frame() {
+	Function *w = functions.ptrw();
+	for (int i = 0; i < functions.size(); ++i) {
+		w[i].frame_call_count = 0;
+		w[i].frame_total_time = 0;
+		w[i].frame_sampled_total_time = 0;
+		w[i].frame_self_time = 0;
+	}
+	last_sample_usec = OS::get_singleton()->get_ticks_usec();
+}
+
+int DuktapeProfiler::fill_info(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max, bool p_frame) const {
+	int count = 0;
+	for (int i = 0; i < functions.size() && count < p_info_max; ++i) {
+		const Function &function = functions[i];
+		const uint64_t self_time = p_frame ? function.frame_self_time : function.self_time;
+		const uint64_t call_count = p_frame ? function.frame_call_count : function.call_count;
+		if (p_frame && self_time == 0 && call_count == 0 && function.frame_sampled_total_time == 0) continue;
+
+		ScriptLanguage::ProfilingInfo &info = p_info_arr[count++];
+		info.signature = function.signature;
+		info.call_count = call_count;
+		info.self_time = self_time;
+		// Functions called from the engine are timed, the others only show up in samples
+		if (function.call_count > 0) {
+			info.total_time = p_frame ? function.frame_total_time : function.total_time;
+		} else {
+			info.total_time = p_frame ? function.frame_sampled_total_time : function.sampled_total_time;
+		}
+	}
+	return count;
+}
+
+DuktapeProfiler::DuktapeProfiler() :
+		active(false),
+		sample_count(0),
+		last_sample_usec(0),
+		call_depth(0) {
+}
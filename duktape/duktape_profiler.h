@@ -0,0 +1,81 @@
+#ifndef DUKTAPE_PROFILER_H
+#define DUKTAPE_PROFILER_H
+
+#include "core/hash_map.h"
+#include "core/script_language.h"
+#include "core/vector.h"
+#include "src/duktape.h"
+
+/**
+ * Sampling profiler of the script functions.
+ *
+ * While profiling, the bytecode executor calls sample() every sample_interval instructions. The time since the
+ * previous sample is added to the self time of the running function and to the total time of every function on
+ * the call stack. Calls from the engine are measured exactly: begin_call and end_call count them and time them.
+ */
+class DuktapeProfiler {
+
+	enum {
+		MAX_SAMPLE_DEPTH = 32,
+	};
+
+	struct Function {
+		StringName signature;
+		uint64_t call_count;
+		uint64_t total_time; // measured calls from the engine
+		uint64_t sampled_total_time;
+		uint64_t self_time;
+		uint64_t frame_call_count;
+		uint64_t frame_total_time;
+		uint64_t frame_sampled_total_time;
+		uint64_t frame_self_time;
+		uint32_t last_sample; // counts the function once in a sample of a recursive call stack
+	};
+
+	// Functions are cached by heap pointer, the name, file and line tell a new function at a reused address
+	struct CachedFunction {
+		const void *name;
+		const void *file_name;
+		duk_int_t line;
+		int index;
+	};
+
+	struct FunctionPtrHash {
+		static _FORCE_INLINE_ uint32_t hash(const void *p_ptr) {
+			return HashMapHasherDefault::hash((uint64_t)(uintptr_t)p_ptr);
+		}
+	};
+
+	Vector<Function> functions;
+	HashMap<String, int> function_indices;
+	HashMap<const void *, CachedFunction, FunctionPtrHash> function_cache;
+
+	bool active;
+	uint32_t sample_count;
+	uint64_t last_sample_usec;
+	int call_depth;
+
+	int get_function(const void *p_ptr, const char *p_name, const char *p_file_name, duk_int_t p_line);
+	void sample(duk_context *ctx);
+	int fill_info(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max, bool p_frame) const;
+
+	static void interrupt_hook(void *udata, duk_context *ctx);
+
+public:
+	_FORCE_INLINE_ bool is_active() const { return active; }
+
+	void start(duk_context *ctx, int p_sample_interval);
+	void stop(duk_context *ctx);
+
+	// The function to be called is at p_func_idx, returns the index of its entry or -1
+	int begin_call(duk_context *ctx, duk_idx_t p_func_idx, uint64_t &r_start_usec);
+	void end_call(int p_function, uint64_t p_start_usec);
+	void frame();
+
+	_FORCE_INLINE_ int get_accumulated_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) const { return fill_info(p_info_arr, p_info_max, false); }
+	_FORCE_INLINE_ int get_frame_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) const { return fill_info(p_info_arr, p_info_max, true); }
+
+	DuktapeProfiler();
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "duktape_binding_helper.h"
+
+/**
+ * Typed fast path of native method calls.
+ *
+ * MethodBind::ptrcall takes its arguments as pointers to native values: integers as int64_t, floats as double
+ * and builtin types as the C++ object itself. Builtin wrapper objects already keep that object in their native
+ * slot so it is passed without any copy. Calls with arguments of an unexpected type fall back to MethodBind::call
+ * which converts them and reports errors like before.
+ */
+
+static bool is_ptrcall_value_type(Variant::Type type) {
+	switch (type) {
+		case Variant::BOOL:
+		case Variant::REAL:
+		case Variant::VECTOR2:
+		case Variant::RECT2:
+		case Variant::VECTOR3:
+		case Variant::TRANSFORM2D:
+		case Variant::PLANE:
+		case Variant::QUAT:
+		case Variant::AABB:
+		case Variant::BASIS:
+		case Variant::TRANSFORM:
+		case Variant::COLOR:
+		case Variant::_RID:
+		case Variant::POOL_BYTE_ARRAY:
+		case Variant::POOL_INT_ARRAY:
+		case Variant::POOL_REAL_ARRAY:
+		case Variant::POOL_STRING_ARRAY:
+		case Variant::POOL_VECTOR2_ARRAY:
+		case Variant::POOL_VECTOR3_ARRAY:
+		case Variant::POOL_COLOR_ARRAY:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool is_ptrcall_argument_type(Variant::Type type) {
+	switch (type) {
+#ifndef BIG_ENDIAN_ENABLED
+		// Enum arguments are read as 32 bit integers from the int64_t storage
+		case Variant::INT:
+#endif
+		case Variant::ARRAY: // lazily marshalled containers only
+		case Variant::DICTIONARY:
+			return true;
+		default:
+			return is_ptrcall_value_type(type);
+	}
+}
+
+void DuktapeBindingHelper::build_method_signature(const MethodBind *mb, MethodSignature &r_signature) {
+
+	r_signature.method = const_cast<MethodBind *>(mb);
+	r_signature.ptrcall = false;
+	r_signature.has_return = mb->has_return();
+	r_signature.return_type = Variant::NIL;
+	r_signature.argument_count = mb->get_argument_count();
+
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+	if (mb->is_vararg() || r_signature.argument_count > MethodSignature::MAX_PTRCALL_ARGS) {
+		return;
+	}
+
+	// Methods returning Variant report NIL, integer returns may be 32 bit enums
+	if (r_signature.has_return) {
+		r_signature.return_type = mb->get_argument_type(-1);
+		if (!is_ptrcall_value_type(r_signature.return_type)) {
+			return;
+		}
+	}
+
+	for (int i = 0; i < r_signature.argument_count; ++i) {
+		r_signature.argument_types[i] = mb->get_argument_type(i);
+		if (!is_ptrcall_argument_type(r_signature.argument_types[i])) {
+			return;
+		}
+	}
+	r_signature.ptrcall = true;
+#endif
+}
+
+duk_ret_t DuktapeBindingHelper::duk_ptrcall_godot_method(duk_context *ctx, Object *obj, const MethodSignature &signature, bool &r_handled) {
+	r_handled = false;
+
+#ifdef PTRCALL_ENABLED
+	union PrimitiveStorage {
+		bool b;
+		int64_t i;
+		double r;
+	};
+
+	PrimitiveStorage values[MethodSignature::MAX_PTRCALL_ARGS];
+	const void *args[MethodSignature::MAX_PTRCALL_ARGS];
+
+	for (int i = 0; i < signature.argument_count; ++i) {
+		const Variant::Type type = signature.argument_types[i];
+		switch (type) {
+			case Variant::BOOL:
+				if (!duk_is_boolean(ctx, i)) return DUK_NO_RET_VAL;
+				values[i].b = duk_get_boolean(ctx, i);
+				args[i] = &values[i];
+				break;
+			case Variant::INT:
+				if (!duk_is_number(ctx, i)) return DUK_NO_RET_VAL;
+				values[i].i = int64_t(duk_get_number(ctx, i));
+				args[i] = &values[i];
+				break;
+			case Variant::REAL:
+				if (!duk_is_number(ctx, i)) return DUK_NO_RET_VAL;
+				values[i].r = duk_get_number(ctx, i);
+				args[i] = &values[i];
+				break;
+			default:
+				if (duk_get_godot_variant_type(ctx, i) != type) return DUK_NO_RET_VAL;
+				args[i] = duk_get_native_ptr(ctx, i);
+				if (NULL == args[i]) return DUK_NO_RET_VAL;
+				break;
+		}
+	}
+
+	r_handled = true;
+	if (!signature.has_return) {
+		HeapUnlock unlock(ctx);
+		signature.method->ptrcall(obj, args, NULL);
+		return DUK_NO_RET_VAL;
+	}
+
+	// The heap is locked again before the result is pushed
+	switch (signature.return_type) {
+		case Variant::BOOL: {
+			bool ret = false;
+			{
+				HeapUnlock unlock(ctx);
+				signature.method->ptrcall(obj, args, &ret);
+			}
+			duk_push_boolean(ctx, ret);
+		} break;
+		case Variant::REAL: {
+			double ret = 0;
+			{
+				HeapUnlock unlock(ctx);
+				signature.method->ptrcall(obj, args, &ret);
+			}
+			duk_push_number(ctx, ret);
+		} break;
+		default: {
+			// The result is written straight into the native storage of the returned wrapper
+			void *ret = create_builtin_payload(signature.return_type, Variant());
+			{
+				HeapUnlock unlock(ctx);
+				signature.method->ptrcall(obj, args, ret);
+			}
+			duk_push_builtin_payload(ctx, signature.return_type, ret);
+		} break;
+	}
+	return DUK_HAS_RET_VAL;
+#else
+	return DUK_NO_RET_VAL;
+#endif
+}
@@ -0,0 +1,136 @@
+#include "core/safe_refcount.h"
+#include "duktape_binding_helper.h"
+
+/**
+ * Script contexts of engine threads.
+ *
+ * Objects used by the physics thread or by Thread jobs call their scripts from those threads. Each of them gets a
+ * Duktape thread of the main heap, created on its first script call and released by thread_exit. Duktape threads
+ * share the global object so the class registry, the godot namespace and the object pools are the same everywhere.
+ *
+ * A Duktape heap can't run on two native threads at once. Entry points from the engine take heap_lock, and native
+ * methods called from scripts suspend the running context and release the lock for the duration of the call.
+ * Script execution is serialized, engine work done by the threads still overlaps.
+ *
+ * A suspended context is still running, Duktape only calls into inactive threads until it is resumed. Native calls
+ * that come back to scripts (signals, notifications, instancing) run on a nested context per suspension level of
+ * their thread, created on first use and reused by the later calls at the same level.
+ */
+
+duk_context *DuktapeBindingHelper::get_thread_context() {
+	const Thread::ID id = Thread::get_caller_id();
+	SuspendedContexts *suspended = suspended_contexts.getptr(id);
+	if (suspended && suspended->depth > 0) {
+		const int level = suspended->depth - 1;
+		if (level < suspended->nested.size()) {
+			return suspended->nested[level];
+		}
+
+		duk_push_heapptr(thread_spawner, thread_context_pool_ptr);
+		duk_push_thread(thread_spawner);
+		duk_context *nested_ctx = duk_get_context(thread_spawner, -1);
+		duk_put_prop_string(thread_spawner, -2, (String::num_uint64(id) + "/" + itos(level)).utf8().get_data());
+		duk_pop(thread_spawner);
+		suspended->nested.push_back(nested_ctx);
+		return nested_ctx;
+	}
+
+	if (id == Thread::get_main_id()) {
+		return ctx;
+	}
+
+	if (duk_context **thread_ctx = thread_contexts.getptr(id)) {
+		return *thread_ctx;
+	}
+
+	// Keep the thread reachable until the native thread exits
+	duk_push_heapptr(thread_spawner, thread_context_pool_ptr);
+	duk_push_thread(thread_spawner);
+	duk_context *thread_ctx = duk_get_context(thread_spawner, -1);
+	duk_put_prop_string(thread_spawner, -2, String::num_uint64(id).utf8().get_data());
+	duk_pop(thread_spawner);
+
+	thread_contexts.set(id, thread_ctx);
+	atomic_increment(&thread_context_count);
+	return thread_ctx;
+}
+
+void DuktapeBindingHelper::lock() {
+	// Same as HeapLock, native calls releasing the heap release this level too
+	if (heap_lock) {
+		heap_lock->lock();
+		++heap_lock_depth;
+	}
+}
+
+void DuktapeBindingHelper::unlock() {
+	if (heap_lock) {
+		--heap_lock_depth;
+		heap_lock->unlock();
+	}
+}
+
+void DuktapeBindingHelper::thread_enter() {
+	// The context is created on the first script call, most engine threads never run scripts
+}
+
+void DuktapeBindingHelper::thread_exit() {
+	if (NULL == ctx || thread_context_count == 0) return;
+
+	const Thread::ID id = Thread::get_caller_id();
+	ERR_FAIL_COND(id == Thread::get_main_id());
+
+	HeapLock lock(this);
+	if (!thread_contexts.has(id)) return;
+	thread_contexts.erase(id);
+	release_nested_contexts(id);
+
+	duk_push_heapptr(thread_spawner, thread_context_pool_ptr);
+	duk_del_prop_string(thread_spawner, -1, String::num_uint64(id).utf8().get_data());
+	duk_pop(thread_spawner);
+	atomic_decrement(&thread_context_count);
+}
+
+void DuktapeBindingHelper::release_nested_contexts(Thread::ID p_id) {
+	SuspendedContexts *suspended = suspended_contexts.getptr(p_id);
+	if (!suspended) return;
+
+	duk_push_heapptr(thread_spawner, thread_context_pool_ptr);
+	for (int i = 0; i < suspended->nested.size(); ++i) {
+		duk_del_prop_string(thread_spawner, -1, (String::num_uint64(p_id) + "/" + itos(i)).utf8().get_data());
+	}
+	duk_pop(thread_spawner);
+	suspended_contexts.erase(p_id);
+}
+
+DuktapeBindingHelper::HeapUnlock::HeapUnlock(duk_context *p_ctx) :
+		ctx(p_ctx) {
+	DuktapeBindingHelper *helper = get_singleton();
+	duk_suspend(ctx, &state);
+	// Entries are only erased by their own thread, the pointer stays valid until the destructor
+	suspended = &helper->suspended_contexts[Thread::get_caller_id()];
+	++suspended->depth;
+	depth = helper->heap_lock_depth;
+	helper->heap_lock_depth = 0;
+	// Other threads may time their own calls meanwhile
+	watchdog_depth = helper->watchdog_depth;
+	watchdog_deadline_usec = helper->watchdog_deadline_usec;
+	unlock_usec = watchdog_deadline_usec ? OS::get_singleton()->get_ticks_usec() : 0;
+	helper->watchdog_depth = 0;
+	helper->watchdog_deadline_usec = 0;
+	for (int i = 0; i < depth; ++i) {
+		helper->heap_lock->unlock();
+	}
+}
+
+DuktapeBindingHelper::HeapUnlock::~HeapUnlock() {
+	DuktapeBindingHelper *helper = get_singleton();
+	for (int i = 0; i < depth; ++i) {
+		helper->heap_lock->lock();
+	}
+	helper->heap_lock_depth = depth;
+	--suspended->depth;
+	helper->watchdog_depth = watchdog_depth;
+	helper->watchdog_deadline_usec = watchdog_deadline_usec ? watchdog_deadline_usec + (OS::get_singleton()->get_ticks_usec() - unlock_usec) : 0;
+	duk_resume(ctx, &state);
+}
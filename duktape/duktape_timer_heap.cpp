@@ -0,0 +1,35 @@
+#include "duktape_timer_heap.h"
+
+void DuktapeTimerHeap::push(uint64_t p_due_usec, uint32_t p_id) {
+	const Timer timer = { p_due_usec, p_id };
+	int i = timers.size();
+	timers.push_back(timer);
+	Timer *w = timers.ptrw();
+	while (i > 0) {
+		const int parent = (i - 1) / 2;
+		if (!is_before(timer, w[parent])) break;
+		w[i] = w[parent];
+		i = parent;
+	}
+	w[i] = timer;
+}
+
+uint32_t DuktapeTimerHeap::pop() {
+	ERR_FAIL_COND_V(timers.empty(), 0);
+	Timer *w = timers.ptrw();
+	const uint32_t id = w[0].id;
+	const int size = timers.size() - 1;
+	const Timer last = w[size];
+	int i = 0;
+	while (true) {
+		int child = i * 2 + 1;
+		if (child >= size) break;
+		if (child + 1 < size && is_before(w[child + 1], w[child])) ++child;
+		if (!is_before(w[child], last)) break;
+		w[i] = w[child];
+		i = child;
+	}
+	w[i] = last;
+	timers.resize(size);
+	return id;
+}
@@ -0,0 +1,33 @@
+#ifndef DUKTAPE_TIMER_HEAP_H
+#define DUKTAPE_TIMER_HEAP_H
+
+#include "core/vector.h"
+
+/**
+ * Binary min-heap of timers ordered by due time, timers due at the same time keep the order of their ids.
+ * Adding and removing a timer is O(log n) and checking for due timers only looks at the top.
+ * Cancelled timers stay in the heap, their owner ignores unknown ids when they are popped.
+ */
+class DuktapeTimerHeap {
+	struct Timer {
+		uint64_t due_usec;
+		uint32_t id;
+	};
+	Vector<Timer> timers;
+
+	static _FORCE_INLINE_ bool is_before(const Timer &a, const Timer &b) {
+		return a.due_usec < b.due_usec || (a.due_usec == b.due_usec && a.id < b.id);
+	}
+
+public:
+	void push(uint64_t p_due_usec, uint32_t p_id);
+	// Removes the earliest timer and returns its id
+	uint32_t pop();
+
+	_FORCE_INLINE_ bool has_due(uint64_t p_now_usec) const { return timers.size() && timers[0].due_usec <= p_now_usec; }
+	_FORCE_INLINE_ bool empty() const { return timers.empty(); }
+	_FORCE_INLINE_ int size() const { return timers.size(); }
+	_FORCE_INLINE_ void clear() { timers.clear(); }
+};
+
+#endif // DUKTAPE_TIMER_HEAP_H
@@ -0,0 +1,346 @@
+#include "duktape_worker.h"
+#include "core/os/file_access.h"
+#include "duktape_binding_helper.h"
+
+DuktapeWorker::DuktapeWorker(const String &p_path, const String &p_source, void *p_main_object) :
+		path(p_path),
+		source(p_source),
+		ctx(NULL),
+		thread(NULL),
+		exit_requested(false),
+		terminating(false),
+		main_object(p_main_object) {
+	heap_limit = DuktapeBindingHelper::get_singleton()->heap_accounting.get_limit();
+	mutex = Mutex::create();
+	semaphore = Semaphore::create();
+}
+
+DuktapeWorker::~DuktapeWorker() {
+	terminate();
+	memdelete(semaphore);
+	memdelete(mutex);
+}
+
+Error DuktapeWorker::start() {
+	ERR_FAIL_COND_V(thread != NULL, ERR_ALREADY_IN_USE);
+	thread = Thread::create(thread_func, this);
+	ERR_FAIL_NULL_V(thread, ERR_CANT_CREATE);
+	return OK;
+}
+
+void DuktapeWorker::terminate() {
+	if (thread == NULL) return;
+
+	// A script stuck in a loop is interrupted by exec_timeout_check
+	terminating = true;
+	exit_requested = true;
+	semaphore->post();
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	thread = NULL;
+}
+
+void DuktapeWorker::post_message(DuktapeMessage &r_message) {
+	if (exit_requested) return;
+
+	// The sender must not keep a reference to transferred arrays or the receiver would copy them on write
+	mutex->lock();
+	inbox.push_back(r_message);
+	r_message = DuktapeMessage();
+	mutex->unlock();
+	semaphore->post();
+}
+
+bool DuktapeWorker::pop_message(DuktapeMessage &r_message) {
+	bool ret = false;
+	mutex->lock();
+	if (!outbox.empty()) {
+		r_message = outbox.front()->get();
+		outbox.pop_front();
+		ret = true;
+	}
+	mutex->unlock();
+	return ret;
+}
+
+DuktapeWorker *DuktapeWorker::get_worker(duk_context *ctx) {
+	duk_memory_functions funcs;
+	duk_get_memory_functions(ctx, &funcs);
+	return static_cast<DuktapeWorker *>(funcs.udata);
+}
+
+void *DuktapeWorker::alloc_function(void *udata, duk_size_t size) {
+	return static_cast<DuktapeWorker *>(udata)->heap_accounting.alloc(size);
+}
+
+void *DuktapeWorker::realloc_function(void *udata, void *ptr, duk_size_t size) {
+	return static_cast<DuktapeWorker *>(udata)->heap_accounting.realloc(ptr, size);
+}
+
+void DuktapeWorker::free_function(void *udata, void *ptr) {
+	static_cast<DuktapeWorker *>(udata)->heap_accounting.free(ptr);
+}
+
+void DuktapeWorker::fatal_function(void *udata, const char *msg) {
+	DuktapeWorker *self = static_cast<DuktapeWorker *>(udata);
+	fprintf(stderr, "*** FATAL ERROR in worker %s: %s\n", self->path.utf8().get_data(), (msg ? msg : "no message"));
+	fflush(stderr);
+	abort();
+}
+
+void DuktapeWorker::register_globals() {
+	duk_push_global_object(ctx);
+
+	duk_push_literal(ctx, "console");
+	duk_push_object(ctx);
+	{
+		duk_push_literal(ctx, "log");
+		duk_push_c_function(ctx, DuktapeBindingHelper::console_log_function, DUK_VARARGS);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "error");
+		duk_push_c_function(ctx, DuktapeBindingHelper::console_error_function, DUK_VARARGS);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "warn");
+		duk_push_c_function(ctx, DuktapeBindingHelper::console_warn_function, DUK_VARARGS);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+	}
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+	duk_push_literal(ctx, "postMessage");
+	duk_push_c_function(ctx, worker_post_message, 2);
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+	duk_push_literal(ctx, "close");
+	duk_push_c_function(ctx, worker_close, 0);
+	duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+	duk_pop(ctx);
+
+	// transferred pool arrays are exposed as TypedArray views
+	DuktapeBindingHelper::register_pool_array_view_finalizer(ctx);
+}
+
+void DuktapeWorker::dispatch_message(DuktapeMessage &p_message) {
+	duk_push_global_object(ctx);
+	duk_get_prop_literal(ctx, -1, "onmessage");
+	if (duk_is_function(ctx, -1)) {
+		duk_dup(ctx, -2);
+		p_message.decode(ctx, false);
+		if (DUK_EXEC_SUCCESS != duk_pcall_method(ctx, 1)) {
+			ERR_PRINTS(path + ": " + duk_safe_to_string(ctx, -1));
+		}
+	}
+	duk_pop_2(ctx);
+}
+
+void DuktapeWorker::thread_func(void *p_userdata) {
+	DuktapeWorker *self = static_cast<DuktapeWorker *>(p_userdata);
+
+	self->ctx = duk_create_heap(alloc_function, realloc_function, free_function, self, fatal_function);
+	ERR_FAIL_NULL(self->ctx);
+	duk_context *ctx = self->ctx;
+	self->register_globals();
+	self->heap_accounting.set_limit(ctx, self->heap_limit);
+
+	DuktapeBindingHelper::duk_push_godot_string(ctx, self->source);
+	DuktapeBindingHelper::duk_push_godot_string(ctx, self->path);
+	if (DUK_EXEC_SUCCESS != duk_pcompile(ctx, DUK_COMPILE_EVAL) || DUK_EXEC_SUCCESS != duk_pcall(ctx, 0)) {
+		ERR_PRINTS(self->path + ": " + duk_safe_to_string(ctx, -1));
+		self->exit_requested = true;
+	}
+	duk_pop(ctx);
+	self->source = String();
+
+	while (!self->exit_requested) {
+		self->semaphore->wait();
+
+		DuktapeMessage message;
+		bool has_message = false;
+		self->mutex->lock();
+		if (!self->inbox.empty()) {
+			message = self->inbox.front()->get();
+			self->inbox.pop_front();
+			has_message = true;
+		}
+		self->mutex->unlock();
+
+		if (has_message && !self->exit_requested) {
+			self->dispatch_message(message);
+		}
+	}
+
+	self->heap_accounting.set_limit(NULL, 0);
+	duk_destroy_heap(ctx);
+	self->ctx = NULL;
+}
+
+bool DuktapeWorker::post_message_to_main(duk_context *ctx) {
+	DuktapeMessage message;
+	if (!message.encode(ctx, 0, duk_is_array(ctx, 1) ? 1 : DUK_INVALID_INDEX)) {
+		return false;
+	}
+	DuktapeWorker *self = get_worker(ctx);
+	self->mutex->lock();
+	self->outbox.push_back(message);
+	message = DuktapeMessage();
+	self->mutex->unlock();
+	return true;
+}
+
+duk_ret_t DuktapeWorker::worker_post_message(duk_context *ctx) {
+	// Errors are thrown from here where the message is already released
+	if (!post_message_to_main(ctx)) {
+		return duk_throw(ctx);
+	}
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeWorker::worker_close(duk_context *ctx) {
+	get_worker(ctx)->exit_requested = true;
+	return DUK_NO_RET_VAL;
+}
+
+/* Worker objects of the main heap */
+
+DuktapeWorker *DuktapeBindingHelper::create_worker(duk_context *ctx, const String &p_path) {
+	const String path = resolve_module_path("res://", p_path);
+	if (path.empty()) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot find worker script '%s'", p_path.utf8().get_data());
+		return NULL;
+	}
+
+	Error err;
+	const String source = FileAccess::get_file_as_string(path, &err);
+	if (err != OK) {
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot read worker script '%s'", path.utf8().get_data());
+		return NULL;
+	}
+
+	duk_push_this(ctx);
+	DuktapeWorker *worker = memnew(DuktapeWorker(path, source, duk_get_heapptr(ctx, -1)));
+	if (worker->start() != OK) {
+		memdelete(worker);
+		duk_pop(ctx);
+		duk_push_error_object(ctx, DUK_ERR_ERROR, "Cannot start worker thread for '%s'", path.utf8().get_data());
+		return NULL;
+	}
+	duk_push_pointer(ctx, worker);
+	duk_put_prop_literal(ctx, -2, DUK_HIDDEN_SYMBOL("worker"));
+	duk_pop(ctx);
+
+	get_singleton()->workers.insert(worker);
+	return worker;
+}
+
+DuktapeWorker *DuktapeBindingHelper::duk_get_worker(duk_context *ctx, duk_idx_t idx) {
+	duk_get_prop_literal(ctx, idx, DUK_HIDDEN_SYMBOL("worker"));
+	DuktapeWorker *worker = static_cast<DuktapeWorker *>(duk_get_pointer(ctx, -1));
+	duk_pop(ctx);
+	return worker;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_worker_constructor(duk_context *ctx) {
+	if (!duk_is_constructor_call(ctx)) {
+		return DUK_RET_TYPE_ERROR;
+	}
+	// Errors are thrown from here where no engine objects are alive on the native stack
+	if (NULL == create_worker(ctx, duk_get_godot_string(ctx, 0, true))) {
+		return duk_throw(ctx);
+	}
+	return DUK_NO_RET_VAL;
+}
+
+bool DuktapeBindingHelper::post_worker_message(duk_context *ctx) {
+	duk_push_this(ctx);
+	DuktapeWorker *worker = duk_get_worker(ctx, -1);
+	duk_pop(ctx);
+	if (NULL == worker || !worker->is_running()) {
+		return true;
+	}
+
+	DuktapeMessage message;
+	if (!message.encode(ctx, 0, duk_is_array(ctx, 1) ? 1 : DUK_INVALID_INDEX)) {
+		return false;
+	}
+	worker->post_message(message);
+	return true;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_worker_post_message(duk_context *ctx) {
+	// Errors are thrown from here where the message is already released
+	if (!post_worker_message(ctx)) {
+		return duk_throw(ctx);
+	}
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_worker_terminate(duk_context *ctx) {
+	duk_push_this(ctx);
+	if (DuktapeWorker *worker = duk_get_worker(ctx, -1)) {
+		worker->terminate();
+	}
+	return DUK_NO_RET_VAL;
+}
+
+duk_ret_t DuktapeBindingHelper::godot_worker_finalizer(duk_context *ctx) {
+	// The finalizer is also called for the prototype which has no worker
+	DuktapeWorker *worker = duk_get_worker(ctx, 0);
+	if (NULL == worker) return DUK_NO_RET_VAL;
+
+	duk_push_pointer(ctx, NULL);
+	duk_put_prop_literal(ctx, 0, DUK_HIDDEN_SYMBOL("worker"));
+	get_singleton()->workers.erase(worker);
+	memdelete(worker);
+	return DUK_NO_RET_VAL;
+}
+
+void DuktapeBindingHelper::duk_push_worker_class(duk_context *ctx) {
+	duk_push_c_function(ctx, godot_worker_constructor, 1);
+	duk_push_object(ctx);
+	{
+		duk_push_literal(ctx, "postMessage");
+		duk_push_c_function(ctx, godot_worker_post_message, 2);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "terminate");
+		duk_push_c_function(ctx, godot_worker_terminate, 0);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE);
+
+		duk_push_literal(ctx, "onmessage");
+		duk_push_null(ctx);
+		duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_VALUE | DUK_DEFPROP_SET_WRITABLE);
+
+		duk_push_c_function(ctx, godot_worker_finalizer, 1);
+		duk_set_finalizer(ctx, -2);
+	}
+	duk_put_prop_literal(ctx, -2, "prototype");
+}
+
+void DuktapeBindingHelper::dispatch_worker_messages() {
+
+	// onmessage callbacks may terminate and collect any worker
+	Vector<DuktapeWorker *> pending;
+	for (Set<DuktapeWorker *>::Element *E = workers.front(); E; E = E->next()) {
+		pending.push_back(E->get());
+	}
+
+	for (int i = 0; i < pending.size(); ++i) {
+		DuktapeWorker *worker = pending[i];
+		DuktapeMessage message;
+		while (workers.has(worker) && worker->pop_message(message)) {
+			duk_push_heapptr(ctx, worker->get_main_object());
+			duk_get_prop_literal(ctx, -1, "onmessage");
+			if (duk_is_function(ctx, -1)) {
+				duk_dup(ctx, -2);
+				message.decode(ctx, true);
+				WatchdogScope watchdog(this);
+				if (DUK_EXEC_SUCCESS != duk_pcall_method(ctx, 1)) {
+					duk_print_error(ctx, -1);
+				}
+			}
+			duk_pop_2(ctx);
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef DUKTAPE_WORKER_H
+#define DUKTAPE_WORKER_H
+
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/variant.h"
+#include "duktape_heap_accounting.h"
+#include "duktape_message.h"
+#include "src/duktape.h"
+
+/**
+ * A library running in its own Duktape heap on a background thread.
+ *
+ * The worker heap only has `console`, `postMessage(data, transfer)`, `close()` and the `onmessage` callback,
+ * the godot API is not available there. Messages are structured clones (see DuktapeMessage), pool arrays
+ * arrive in the worker as TypedArrays.
+ */
+class DuktapeWorker {
+
+	String path;
+	String source;
+
+	duk_context *ctx;
+	Thread *thread;
+	Mutex *mutex;
+	Semaphore *semaphore;
+	volatile bool exit_requested;
+	volatile bool terminating; // interrupts the running script, close() lets it finish
+
+	List<DuktapeMessage> inbox; // main thread to worker
+	List<DuktapeMessage> outbox; // worker to main thread
+
+	void *main_object; // the Worker object in the main heap
+
+	// memory of the worker heap, only used by the worker thread
+	DuktapeHeapAccounting heap_accounting;
+	uint64_t heap_limit; // applied once the globals are registered
+
+	static void *alloc_function(void *udata, duk_size_t size);
+	static void *realloc_function(void *udata, void *ptr, duk_size_t size);
+	static void free_function(void *udata, void *ptr);
+	static void thread_func(void *p_userdata);
+	static void fatal_function(void *udata, const char *msg);
+	static DuktapeWorker *get_worker(duk_context *ctx);
+
+	void register_globals();
+	void dispatch_message(DuktapeMessage &p_message);
+	static bool post_message_to_main(duk_context *ctx);
+
+	// functions of the worker heap
+	static duk_ret_t worker_post_message(duk_context *ctx);
+	static duk_ret_t worker_close(duk_context *ctx);
+
+public:
+	Error start();
+	void terminate();
+	_FORCE_INLINE_ bool is_running() const { return thread != NULL; }
+	_FORCE_INLINE_ bool is_terminating() const { return terminating; }
+
+	// The message is moved to the queue
+	void post_message(DuktapeMessage &r_message);
+	bool pop_message(DuktapeMessage &r_message);
+
+	_FORCE_INLINE_ void *get_main_object() const { return main_object; }
+
+	DuktapeWorker(const String &p_path, const String &p_source, void *p_main_object);
+	~DuktapeWorker();
+};
+
+#endif // DUKTAPE_WORKER_H
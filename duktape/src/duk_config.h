@@ -2985,6 +2985,23 @@ typedef struct duk_hthread duk_context;
  */
 
 /* __OVERRIDE_DEFINES__ */
+
+/* Godot wrapper objects keep their native pointer and Variant type in a
+ * fixed slot of duk_hobject instead of hidden symbol properties.
+ */
+#define DUK_USE_HOBJECT_NATIVE_SLOT
+
+/* Heap usage by value category, duk_get_heap_usage(). */
+#define DUK_USE_HEAP_USAGE
+
+/* Integer-preserving number representation, enabled by building with
+ * ecmascript_fastint=yes.  Requires DUK_USE_64BIT_OPS.
+ */
+#if defined(ECMASCRIPT_FASTINT)
+#undef DUK_USE_FASTINT
+#define DUK_USE_FASTINT
+#endif
+
 #ifdef DEBUG_ENABLED
 
 #define DUK_USE_DEBUGGER_SUPPORT
@@ -2994,7 +3011,26 @@ typedef struct duk_hthread duk_context;
 #define DUK_USE_DEBUGGER_PAUSE_UNCAUGHT
 #define DUK_USE_DEBUGGER_DUMPHEAP
 
+/* Interrupt callback for the sampling profiler, duk_set_interrupt_hook().
+ * Requires DUK_USE_INTERRUPT_COUNTER.
+ */
+#define DUK_USE_INTERRUPT_HOOK
+
+#endif
+
+/* Execution watchdog: scripts running past the time budget of their call
+ * are interrupted with a RangeError, see DuktapeBindingHelper::WatchdogScope.
+ * Checked every DUK_HTHREAD_INTCTR_DEFAULT instructions.
+ */
+#if !defined(DUK_USE_INTERRUPT_COUNTER)
+#define DUK_USE_INTERRUPT_COUNTER
+#endif
+#if defined(__cplusplus)
+extern "C" duk_bool_t ecmascript_exec_timeout_check(void *udata);
+#else
+extern duk_bool_t ecmascript_exec_timeout_check(void *udata);
 #endif
+#define DUK_USE_EXEC_TIMEOUT_CHECK(udata) ecmascript_exec_timeout_check((udata))
 
 /*
  *  Conditional includes
@@ -6881,6 +6881,16 @@ struct duk_hobject {
 	duk_uint32_t h_size;  /* hash part size or 0 if unused */
 #endif
 #endif
+
+#if defined(DUK_USE_HOBJECT_NATIVE_SLOT)
+	/* Embedder owned native payload: an opaque pointer and an integer tag.
+	 * Kept outside 'props' so that reading it is O(1) and never walks the
+	 * property table or the prototype chain.  Not reachable by GC; a zero
+	 * tag means no payload was set.
+	 */
+	void *native_ptr;
+	duk_int_t native_tag;
+#endif
 };
 
 /*
@@ -8749,6 +8759,13 @@ struct duk_heap {
 	 */
 	void *heap_udata;
 
+#if defined(DUK_USE_INTERRUPT_HOOK)
+	/* Embedder callback called from the executor interrupt. */
+	duk_interrupt_function interrupt_hook;
+	void *interrupt_hook_udata;
+	duk_int_t interrupt_hook_interval;
+#endif
+
 	/* Fatal error handling, called e.g. when a longjmp() is needed but
 	 * lj.jmpbuf_ptr is NULL.  fatal_func must never return; it's not
 	 * declared as "noreturn" because doing that for typedefs is a bit
@@ -9712,7 +9729,7 @@ DUK_INTERNAL_DECL duk_bool_t duk_fb_is_full(duk_fixedbuffer *fb);
 		return DUK_RET_ERROR; \
 	} while (0)
 #define DUK_ERROR_ALLOC_FAILED(thr) do { \
-		duk_err_error((thr)); \
+		duk_err_range((thr)); \
 	} while (0)
 #define DUK_ERROR_UNSUPPORTED(thr) do { \
 		duk_err_error((thr)); \
@@ -11697,7 +11714,10 @@ DUK_INTERNAL DUK_COLD void duk_err_error_internal(duk_hthread *thr, const char *
 	DUK_ERROR_RAW(thr, filename, linenumber, DUK_ERR_ERROR, DUK_STR_INTERNAL_ERROR);
 }
 DUK_INTERNAL DUK_COLD void duk_err_error_alloc_failed(duk_hthread *thr, const char *filename, duk_int_t linenumber) {
-	DUK_ERROR_RAW(thr, filename, linenumber, DUK_ERR_ERROR, DUK_STR_ALLOC_FAILED);
+	/* RangeError so scripts can tell a refused allocation (heap limit of
+	 * the embedder) from other errors.
+	 */
+	DUK_ERROR_RAW(thr, filename, linenumber, DUK_ERR_RANGE_ERROR, DUK_STR_ALLOC_FAILED);
 }
 DUK_INTERNAL DUK_COLD void duk_err_error(duk_hthread *thr, const char *filename, duk_int_t linenumber, const char *message) {
 	DUK_ERROR_RAW(thr, filename, linenumber, DUK_ERR_ERROR, message);
@@ -14663,6 +14683,55 @@ DUK_EXTERNAL void duk_set_magic(duk_hthread *thr, duk_idx_t idx, duk_int_t magic
 	nf->magic = (duk_int16_t) magic;
 }
 
+/*
+ *  Native payload slot
+ */
+
+#if defined(DUK_USE_HOBJECT_NATIVE_SLOT)
+DUK_EXTERNAL void duk_set_native_slot(duk_hthread *thr, duk_idx_t idx, void *ptr, duk_int_t tag) {
+	duk_hobject *h;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	h = duk_require_hobject(thr, idx);
+	DUK_ASSERT(h != NULL);
+	h->native_ptr = ptr;
+	h->native_tag = tag;
+}
+
+DUK_EXTERNAL void *duk_get_native_ptr(duk_hthread *thr, duk_idx_t idx) {
+	duk_tval *tv;
+	duk_hobject *h;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	tv = duk_get_tval_or_unused(thr, idx);
+	DUK_ASSERT(tv != NULL);
+	if (DUK_UNLIKELY(!DUK_TVAL_IS_OBJECT(tv))) {
+		return NULL;
+	}
+	h = DUK_TVAL_GET_OBJECT(tv);
+	DUK_ASSERT(h != NULL);
+	return h->native_ptr;
+}
+
+DUK_EXTERNAL duk_int_t duk_get_native_tag(duk_hthread *thr, duk_idx_t idx, duk_int_t def_value) {
+	duk_tval *tv;
+	duk_hobject *h;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	tv = duk_get_tval_or_unused(thr, idx);
+	DUK_ASSERT(tv != NULL);
+	if (DUK_UNLIKELY(!DUK_TVAL_IS_OBJECT(tv))) {
+		return def_value;
+	}
+	h = DUK_TVAL_GET_OBJECT(tv);
+	DUK_ASSERT(h != NULL);
+	return h->native_tag != 0 ? h->native_tag : def_value;
+}
+#endif  /* DUK_USE_HOBJECT_NATIVE_SLOT */
+
 /*
  *  Misc helpers
  */
@@ -16502,6 +16571,139 @@ DUK_EXTERNAL void duk_inspect_callstack_entry(duk_hthread *thr, duk_int_t level)
 #undef DUK__IDX_TSTATE
 #undef DUK__IDX_TYPE
 #undef DUK__IDX_VARIANT
+
+#if defined(DUK_USE_HEAP_USAGE)
+DUK_LOCAL void duk__heap_usage_add(duk_heap *heap, duk_heaphdr *hdr, duk_heap_usage *usage) {
+	DUK_UNREF(heap);
+
+	switch ((duk_small_int_t) DUK_HEAPHDR_GET_TYPE(hdr)) {
+	case DUK_HTYPE_STRING: {
+		duk_hstring *h_str = (duk_hstring *) hdr;
+		usage->string_count++;
+		usage->string_bytes += sizeof(duk_hstring) + DUK_HSTRING_GET_BYTELEN(h_str) + 1;
+		break;
+	}
+	case DUK_HTYPE_OBJECT: {
+		duk_hobject *h_obj = (duk_hobject *) hdr;
+		duk_size_t size = DUK_HOBJECT_P_ALLOC_SIZE(h_obj);
+
+		if (DUK_HOBJECT_IS_COMPFUNC(h_obj)) {
+			usage->function_count++;
+			usage->function_bytes += sizeof(duk_hcompfunc) + size;
+		} else if (DUK_HOBJECT_IS_NATFUNC(h_obj)) {
+			usage->function_count++;
+			usage->function_bytes += sizeof(duk_hnatfunc) + size;
+		} else if (DUK_HOBJECT_IS_THREAD(h_obj)) {
+			duk_hthread *h_thr = (duk_hthread *) h_obj;
+			usage->thread_count++;
+			usage->thread_bytes += sizeof(duk_hthread) + size;
+			if (h_thr->valstack != NULL) {
+				usage->thread_bytes += (duk_size_t) ((duk_uint8_t *) h_thr->valstack_alloc_end - (duk_uint8_t *) h_thr->valstack);
+			}
+		} else {
+			usage->object_count++;
+			if (DUK_HOBJECT_IS_ARRAY(h_obj)) {
+				usage->object_bytes += sizeof(duk_harray) + size;
+#if defined(DUK_USE_BUFFEROBJECT_SUPPORT)
+			} else if (DUK_HOBJECT_IS_BUFOBJ(h_obj)) {
+				usage->object_bytes += sizeof(duk_hbufobj) + size;
+#endif
+			} else {
+				usage->object_bytes += sizeof(duk_hobject) + size;
+			}
+		}
+		break;
+	}
+	case DUK_HTYPE_BUFFER: {
+		duk_hbuffer *h_buf = (duk_hbuffer *) hdr;
+		if (DUK_HEAPHDR_HAS_TEMPROOT(hdr)) {
+			/* Marked by duk__heap_usage_mark_bytecode(). */
+			DUK_HEAPHDR_CLEAR_TEMPROOT(hdr);
+			usage->bytecode_bytes += sizeof(duk_hbuffer_fixed) + DUK_HBUFFER_GET_SIZE(h_buf);
+			break;
+		}
+		usage->buffer_count++;
+		if (DUK_HBUFFER_HAS_DYNAMIC(h_buf)) {
+			if (DUK_HBUFFER_HAS_EXTERNAL(h_buf)) {
+				usage->buffer_bytes += sizeof(duk_hbuffer_external);
+			} else {
+				usage->buffer_bytes += sizeof(duk_hbuffer_dynamic) + DUK_HBUFFER_GET_SIZE(h_buf);
+			}
+		} else {
+			usage->buffer_bytes += sizeof(duk_hbuffer_fixed) + DUK_HBUFFER_GET_SIZE(h_buf);
+		}
+		break;
+	}
+	}
+}
+
+/* Closures share the data buffer of their template, the buffers are
+ * marked with the mark-and-sweep TEMPROOT flag (unused outside of it)
+ * so each one is counted once.  No allocation happens until the marks
+ * are cleared.
+ */
+DUK_LOCAL void duk__heap_usage_mark_bytecode(duk_heap *heap, duk_heaphdr *list) {
+	duk_heaphdr *hdr;
+	duk_hbuffer *h_data;
+
+	DUK_UNREF(heap);
+
+	for (hdr = list; hdr != NULL; hdr = DUK_HEAPHDR_GET_NEXT(heap, hdr)) {
+		if (DUK_HEAPHDR_GET_TYPE(hdr) == DUK_HTYPE_OBJECT && DUK_HOBJECT_IS_COMPFUNC((duk_hobject *) hdr)) {
+			h_data = (duk_hbuffer *) DUK_HCOMPFUNC_GET_DATA(heap, (duk_hcompfunc *) hdr);
+			if (h_data != NULL) {
+				DUK_HEAPHDR_SET_TEMPROOT((duk_heaphdr *) h_data);
+			}
+		}
+	}
+}
+
+DUK_EXTERNAL void duk_get_heap_usage(duk_hthread *thr, duk_heap_usage *out_usage) {
+	duk_heap *heap;
+	duk_heaphdr *hdr;
+	duk_hstring *h_str;
+	duk_uint32_t i;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_ASSERT(out_usage != NULL);
+
+	heap = thr->heap;
+	duk_memzero((void *) out_usage, sizeof(*out_usage));
+
+	duk__heap_usage_mark_bytecode(heap, heap->heap_allocated);
+#if defined(DUK_USE_FINALIZER_SUPPORT)
+	duk__heap_usage_mark_bytecode(heap, heap->finalize_list);
+#endif
+	for (hdr = heap->heap_allocated; hdr != NULL; hdr = DUK_HEAPHDR_GET_NEXT(heap, hdr)) {
+		duk__heap_usage_add(heap, hdr, out_usage);
+	}
+#if defined(DUK_USE_FINALIZER_SUPPORT)
+	for (hdr = heap->finalize_list; hdr != NULL; hdr = DUK_HEAPHDR_GET_NEXT(heap, hdr)) {
+		duk__heap_usage_add(heap, hdr, out_usage);
+	}
+#endif
+	for (i = 0; i < heap->st_size; i++) {
+#if defined(DUK_USE_STRTAB_PTRCOMP)
+		h_str = DUK_USE_HEAPPTR_DEC16((heap)->heap_udata, heap->strtable16[i]);
+#else
+		h_str = heap->strtable[i];
+#endif
+		while (h_str != NULL) {
+			duk__heap_usage_add(heap, (duk_heaphdr *) h_str, out_usage);
+			h_str = h_str->hdr.h_next;
+		}
+	}
+}
+
+DUK_EXTERNAL duk_bool_t duk_has_catcher(duk_hthread *thr) {
+	DUK_ASSERT_API_ENTRY(thr);
+
+	/* Protected calls and the executor set up a catchpoint, an error
+	 * escaping the executor is rethrown to the enclosing one.
+	 */
+	return thr->heap->lj.jmpbuf_ptr != NULL;
+}
+#endif  /* DUK_USE_HEAP_USAGE */
 #line 1 "duk_api_memory.c"
 /*
  *  Memory calls.
@@ -21598,6 +21800,26 @@ DUK_EXTERNAL duk_bool_t duk_is_number(duk_hthread *thr, duk_idx_t idx) {
 	return DUK_TVAL_IS_NUMBER(tv);
 }
 
+/* Number stored in the fastint representation, always false without
+ * DUK_USE_FASTINT.
+ */
+DUK_EXTERNAL duk_bool_t duk_is_fastint(duk_hthread *thr, duk_idx_t idx) {
+#if defined(DUK_USE_FASTINT)
+	duk_tval *tv;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	tv = duk_get_tval_or_unused(thr, idx);
+	DUK_ASSERT(tv != NULL);
+	return DUK_TVAL_IS_FASTINT(tv);
+#else
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(thr);
+	DUK_UNREF(idx);
+	return 0;
+#endif
+}
+
 DUK_EXTERNAL duk_bool_t duk_is_nan(duk_hthread *thr, duk_idx_t idx) {
 	/* XXX: This will now return false for non-numbers, even though they would
 	 * coerce to NaN (as a general rule).  In particular, duk_get_number()
@@ -21957,6 +22179,21 @@ DUK_EXTERNAL void duk_push_number(duk_hthread *thr, duk_double_t val) {
 	DUK_TVAL_SET_NUMBER(tv_slot, du.d);
 }
 
+/* Like duk_push_number() but whole numbers within the fastint range are
+ * stored as fastints, same as arithmetic results.
+ */
+DUK_EXTERNAL void duk_push_number_chkfast(duk_hthread *thr, duk_double_t val) {
+	duk_tval *tv_slot;
+	duk_double_union du;
+
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK__CHECK_SPACE();
+	du.d = val;
+	DUK_DBLUNION_NORMALIZE_NAN_CHECK(&du);
+	tv_slot = thr->valstack_top++;
+	DUK_TVAL_SET_NUMBER_CHKFAST_FAST(tv_slot, du.d);
+}
+
 DUK_EXTERNAL void duk_push_int(duk_hthread *thr, duk_int_t val) {
 #if defined(DUK_USE_FASTINT)
 	duk_tval *tv_slot;
@@ -22952,6 +23189,33 @@ DUK_EXTERNAL void duk_push_buffer_object(duk_hthread *thr, duk_idx_t idx_buffer,
 	DUK_ERROR_TYPE(thr, DUK_STR_INVALID_ARGS);
 	DUK_WO_NORETURN(return;);
 }
+
+/* Reverse of duk_push_buffer_object() flags: returns the DUK_BUFOBJ_xxx
+ * type of the buffer object at 'idx', or -1 if the value is not a buffer
+ * object.  Node.js Buffers are reported as DUK_BUFOBJ_UINT8ARRAY.
+ */
+DUK_EXTERNAL duk_int_t duk_get_buffer_object_type(duk_hthread *thr, duk_idx_t idx) {
+	duk_hobject *h;
+	duk_small_uint_t classnum;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	h = duk_get_hobject(thr, idx);
+	if (h == NULL || !DUK_HOBJECT_IS_BUFOBJ(h)) {
+		return -1;
+	}
+
+	classnum = DUK_HOBJECT_GET_CLASS_NUMBER(h);
+	switch (classnum) {
+	case DUK_HOBJECT_CLASS_ARRAYBUFFER:
+		return DUK_BUFOBJ_ARRAYBUFFER;
+	case DUK_HOBJECT_CLASS_DATAVIEW:
+		return DUK_BUFOBJ_DATAVIEW;
+	default:
+		DUK_ASSERT(classnum >= DUK_HOBJECT_CLASS_INT8ARRAY && classnum <= DUK_HOBJECT_CLASS_FLOAT64ARRAY);
+		return (duk_int_t) (classnum - DUK_HOBJECT_CLASS_INT8ARRAY) + DUK_BUFOBJ_INT8ARRAY;
+	}
+}
 #else  /* DUK_USE_BUFFEROBJECT_SUPPORT */
 DUK_EXTERNAL void duk_push_buffer_object(duk_hthread *thr, duk_idx_t idx_buffer, duk_size_t byte_offset, duk_size_t byte_length, duk_uint_t flags) {
 	DUK_ASSERT_API_ENTRY(thr);
@@ -22962,6 +23226,12 @@ DUK_EXTERNAL void duk_push_buffer_object(duk_hthread *thr, duk_idx_t idx_buffer,
 	DUK_ERROR_UNSUPPORTED(thr);
 	DUK_WO_NORETURN(return;);
 }
+
+DUK_EXTERNAL duk_int_t duk_get_buffer_object_type(duk_hthread *thr, duk_idx_t idx) {
+	DUK_ASSERT_API_ENTRY(thr);
+	DUK_UNREF(idx);
+	return -1;
+}
 #endif  /* DUK_USE_BUFFEROBJECT_SUPPORT */
 
 DUK_EXTERNAL duk_idx_t duk_push_error_object_va_raw(duk_hthread *thr, duk_errcode_t err_code, const char *filename, duk_int_t line, const char *fmt, va_list ap) {
@@ -47954,6 +48224,11 @@ duk_heap *duk_heap_alloc(duk_alloc_function alloc_func,
 	res->free_func = free_func;
 	res->heap_udata = heap_udata;
 	res->fatal_func = fatal_func;
+#if defined(DUK_USE_INTERRUPT_HOOK)
+	res->interrupt_hook = NULL;
+	res->interrupt_hook_udata = NULL;
+	res->interrupt_hook_interval = DUK_HTHREAD_INTCTR_DEFAULT;
+#endif
 
 	/* XXX: for now there's a pointer packing zero assumption, i.e.
 	 * NULL <=> compressed pointer 0.  If this is removed, may need
@@ -53002,6 +53277,9 @@ DUK_LOCAL void duk__init_object_parts(duk_heap *heap, duk_uint_t hobject_flags,
 #if defined(DUK_USE_EXPLICIT_NULL_INIT)
 	DUK_HOBJECT_SET_PROTOTYPE(heap, obj, NULL);
 	DUK_HOBJECT_SET_PROPS(heap, obj, NULL);
+#if defined(DUK_USE_HOBJECT_NATIVE_SLOT)
+	obj->native_ptr = NULL;
+#endif
 #endif
 #if defined(DUK_USE_HEAPPTR16)
 	/* Zero encoded pointer is required to match NULL. */
@@ -54247,6 +54525,77 @@ DUK_INTERNAL duk_uint_fast32_t duk_hobject_pc2line_query(duk_hthread *thr, duk_i
 }
 
 #endif  /* DUK_USE_PC2LINE */
+
+/*
+ *  Interrupt hook and function info lookups which don't touch the value
+ *  stack, safe to use from the interrupt hook.
+ */
+
+#if defined(DUK_USE_INTERRUPT_HOOK)
+DUK_EXTERNAL void duk_set_interrupt_hook(duk_hthread *thr, duk_interrupt_function func, void *udata, duk_int_t interval) {
+	DUK_ASSERT_API_ENTRY(thr);
+
+	if (interval <= 0) {
+		interval = DUK_HTHREAD_INTCTR_DEFAULT;
+	}
+	thr->heap->interrupt_hook = func;
+	thr->heap->interrupt_hook_udata = udata;
+	thr->heap->interrupt_hook_interval = interval;
+
+	/* Other threads pick the interval up at their next interrupt. */
+	thr->interrupt_init = interval;
+	thr->interrupt_counter = interval - 1;
+}
+
+DUK_LOCAL void *duk__get_function_info(duk_hthread *thr, duk_hobject *func, const char **out_name, const char **out_file_name, duk_int_t *out_line) {
+	duk_tval *tv;
+
+	*out_name = NULL;
+	*out_file_name = NULL;
+	*out_line = 0;
+	if (func == NULL || !DUK_HOBJECT_IS_CALLABLE(func)) {
+		return NULL;
+	}
+
+	tv = duk_hobject_find_existing_entry_tval_ptr(thr->heap, func, DUK_HTHREAD_STRING_NAME(thr));
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		*out_name = (const char *) DUK_HSTRING_GET_DATA(DUK_TVAL_GET_STRING(tv));
+	}
+	tv = duk_hobject_find_existing_entry_tval_ptr(thr->heap, func, DUK_HTHREAD_STRING_FILE_NAME(thr));
+	if (tv != NULL && DUK_TVAL_IS_STRING(tv)) {
+		*out_file_name = (const char *) DUK_HSTRING_GET_DATA(DUK_TVAL_GET_STRING(tv));
+	}
+#if defined(DUK_USE_PC2LINE)
+	if (DUK_HOBJECT_IS_COMPFUNC(func)) {
+		tv = duk_hobject_find_existing_entry_tval_ptr(thr->heap, func, DUK_HTHREAD_STRING_INT_PC2LINE(thr));
+		if (tv != NULL && DUK_TVAL_IS_BUFFER(tv)) {
+			*out_line = (duk_int_t) duk__hobject_pc2line_query_raw(thr, (duk_hbuffer_fixed *) (void *) DUK_TVAL_GET_BUFFER(tv), 0);
+		}
+	}
+#endif
+	return (void *) func;
+}
+
+DUK_EXTERNAL void *duk_get_callstack_function_info(duk_hthread *thr, duk_int_t level, const char **out_name, const char **out_file_name, duk_int_t *out_line) {
+	duk_activation *act;
+
+	DUK_ASSERT_API_ENTRY(thr);
+
+	/* -1 is the running function, -2 its caller and so on. */
+	act = thr->callstack_curr;
+	while (act != NULL && level < -1) {
+		act = act->parent;
+		level++;
+	}
+	return duk__get_function_info(thr, act != NULL && level == -1 ? DUK_ACT_GET_FUNC(act) : NULL, out_name, out_file_name, out_line);
+}
+
+DUK_EXTERNAL void *duk_get_function_info(duk_hthread *thr, duk_idx_t idx, const char **out_name, const char **out_file_name, duk_int_t *out_line) {
+	DUK_ASSERT_API_ENTRY(thr);
+
+	return duk__get_function_info(thr, duk_get_hobject(thr, idx), out_name, out_file_name, out_line);
+}
+#endif  /* DUK_USE_INTERRUPT_HOOK */
 #line 1 "duk_hobject_props.c"
 /*
  *  duk_hobject property access functionality.
@@ -75136,6 +75485,13 @@ DUK_LOCAL DUK__NOINLINE_PERF DUK_COLD duk_small_uint_t duk__executor_interrupt(d
 	}
 #endif  /* DUK_USE_EXEC_TIMEOUT_CHECK */
 
+#if defined(DUK_USE_INTERRUPT_HOOK)
+	if (thr->heap->interrupt_hook != NULL) {
+		thr->heap->interrupt_hook(thr->heap->interrupt_hook_udata, thr);
+		ctr = thr->heap->interrupt_hook_interval;
+	}
+#endif  /* DUK_USE_INTERRUPT_HOOK */
+
 #if defined(DUK_USE_DEBUGGER_SUPPORT)
 	if (!thr->heap->dbg_processing &&
 	    (thr->heap->dbg_read_cb != NULL || thr->heap->dbg_detaching)) {
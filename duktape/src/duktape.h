@@ -240,6 +240,7 @@ typedef void (*duk_debug_read_flush_function) (void *udata);
 typedef void (*duk_debug_write_flush_function) (void *udata);
 typedef duk_idx_t (*duk_debug_request_function) (duk_context *ctx, void *udata, duk_idx_t nvalues);
 typedef void (*duk_debug_detached_function) (duk_context *ctx, void *udata);
+typedef void (*duk_interrupt_function) (void *udata, duk_context *ctx);
 
 struct duk_thread_state {
 	/* XXX: Enough space to hold internal suspend/resume structure.
@@ -669,6 +670,7 @@ DUK_EXTERNAL_DECL void duk_push_boolean(duk_context *ctx, duk_bool_t val);
 DUK_EXTERNAL_DECL void duk_push_true(duk_context *ctx);
 DUK_EXTERNAL_DECL void duk_push_false(duk_context *ctx);
 DUK_EXTERNAL_DECL void duk_push_number(duk_context *ctx, duk_double_t val);
+DUK_EXTERNAL_DECL void duk_push_number_chkfast(duk_context *ctx, duk_double_t val);
 DUK_EXTERNAL_DECL void duk_push_nan(duk_context *ctx);
 DUK_EXTERNAL_DECL void duk_push_int(duk_context *ctx, duk_int_t val);
 DUK_EXTERNAL_DECL void duk_push_uint(duk_context *ctx, duk_uint_t val);
@@ -761,6 +763,7 @@ DUK_EXTERNAL_DECL void *duk_push_buffer_raw(duk_context *ctx, duk_size_t size, d
 #define DUK_BUFOBJ_FLOAT64ARRAY        11
 
 DUK_EXTERNAL_DECL void duk_push_buffer_object(duk_context *ctx, duk_idx_t idx_buffer, duk_size_t byte_offset, duk_size_t byte_length, duk_uint_t flags);
+DUK_EXTERNAL_DECL duk_int_t duk_get_buffer_object_type(duk_context *ctx, duk_idx_t idx);
 
 DUK_EXTERNAL_DECL duk_idx_t duk_push_heapptr(duk_context *ctx, void *ptr);
 
@@ -792,6 +795,7 @@ DUK_EXTERNAL_DECL duk_bool_t duk_is_null(duk_context *ctx, duk_idx_t idx);
 
 DUK_EXTERNAL_DECL duk_bool_t duk_is_boolean(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL duk_bool_t duk_is_number(duk_context *ctx, duk_idx_t idx);
+DUK_EXTERNAL_DECL duk_bool_t duk_is_fastint(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL duk_bool_t duk_is_nan(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL duk_bool_t duk_is_string(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL duk_bool_t duk_is_object(duk_context *ctx, duk_idx_t idx);
@@ -1133,6 +1137,62 @@ DUK_EXTERNAL_DECL duk_int_t duk_get_magic(duk_context *ctx, duk_idx_t idx);
 DUK_EXTERNAL_DECL void duk_set_magic(duk_context *ctx, duk_idx_t idx, duk_int_t magic);
 DUK_EXTERNAL_DECL duk_int_t duk_get_current_magic(duk_context *ctx);
 
+/*
+ *  Native payload slot (DUK_USE_HOBJECT_NATIVE_SLOT)
+ */
+
+#if defined(DUK_USE_HOBJECT_NATIVE_SLOT)
+DUK_EXTERNAL_DECL void duk_set_native_slot(duk_context *ctx, duk_idx_t idx, void *ptr, duk_int_t tag);
+DUK_EXTERNAL_DECL void *duk_get_native_ptr(duk_context *ctx, duk_idx_t idx);
+DUK_EXTERNAL_DECL duk_int_t duk_get_native_tag(duk_context *ctx, duk_idx_t idx, duk_int_t def_value);
+#endif
+
+/*
+ *  Heap usage (DUK_USE_HEAP_USAGE)
+ *
+ *  duk_get_heap_usage() walks the heap and sums the memory used by each
+ *  kind of value.  Sizes are those of duk_inspect_value(), allocator
+ *  overhead and the string table are not included.  Bytecode shared by
+ *  closures is counted once, in bytecode_bytes rather than buffer_bytes.
+ *
+ *  duk_has_catcher() tells whether an error thrown now would be caught
+ *  instead of reaching the fatal handler, e.g. for an allocator deciding
+ *  whether an allocation may fail.
+ */
+
+#if defined(DUK_USE_HEAP_USAGE)
+typedef struct duk_heap_usage {
+	duk_size_t string_count;
+	duk_size_t string_bytes;
+	duk_size_t object_count;
+	duk_size_t object_bytes;
+	duk_size_t function_count;
+	duk_size_t function_bytes;
+	duk_size_t bytecode_bytes;
+	duk_size_t thread_count;
+	duk_size_t thread_bytes;
+	duk_size_t buffer_count;
+	duk_size_t buffer_bytes;
+} duk_heap_usage;
+
+DUK_EXTERNAL_DECL void duk_get_heap_usage(duk_context *ctx, duk_heap_usage *out_usage);
+DUK_EXTERNAL_DECL duk_bool_t duk_has_catcher(duk_context *ctx);
+#endif
+
+/*
+ *  Interrupt hook (DUK_USE_INTERRUPT_HOOK)
+ *
+ *  The hook is called by the bytecode executor every 'interval' executed
+ *  instructions.  It runs inside the executor interrupt and may only use
+ *  duk_get_callstack_function_info() on the given context.
+ */
+
+#if defined(DUK_USE_INTERRUPT_HOOK)
+DUK_EXTERNAL_DECL void duk_set_interrupt_hook(duk_context *ctx, duk_interrupt_function func, void *udata, duk_int_t interval);
+DUK_EXTERNAL_DECL void *duk_get_callstack_function_info(duk_context *ctx, duk_int_t level, const char **out_name, const char **out_file_name, duk_int_t *out_line);
+DUK_EXTERNAL_DECL void *duk_get_function_info(duk_context *ctx, duk_idx_t idx, const char **out_name, const char **out_file_name, duk_int_t *out_line);
+#endif
+
 /*
  *  Module helpers: put multiple function or constant properties
  */
@@ -48,6 +48,11 @@ ScriptInstance *ECMAScript::instance_create(Object *p_this) {
 	instance->owner = p_this;
 	instance->owner->set_script_instance(instance);
 	instance->ecma_object = ecma_instance;
+	{
+		// Instances of engine threads are created and deleted concurrently
+		ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_singleton()->binding);
+		instances.insert(p_this);
+	}
 
 	return instance;
 }
@@ -75,12 +80,35 @@ Error ECMAScript::reload(bool p_keep_state) {
 	ECMAClassInfo *cls = get_ecma_class();
 	ERR_FAIL_COND_V(cls == NULL || library.is_null(), ERR_INVALID_DATA);
 
-	library->reload_from_file();
+	return library->reload(p_keep_state);
+}
+
+void ECMAScript::rebind_instances(const HashMap<StringName, ECMAProperyInfo> &p_old_properties, bool p_keep_state) {
 
-	return OK;
+	ECMAClassInfo *cls = get_ecma_class();
+	ERR_FAIL_NULL(cls);
+	ECMAScriptBindingHelper *binding = ECMAScriptLanguage::get_singleton()->binding;
+	ECMAScriptBindingHelper::Lock lock(binding);
+
+	for (Set<Object *>::Element *E = instances.front(); E; E = E->next()) {
+		ECMAScriptInstance *instance = static_cast<ECMAScriptInstance *>(E->get()->get_script_instance());
+		ERR_CONTINUE(instance == NULL || instance->ecma_object.is_null());
+		binding->rebind_instance(instance->ecma_object, *cls);
+
+		// Values stay on the object, reset the ones that should not survive the reload
+		for (const StringName *name = cls->properties.next(NULL); name; name = cls->properties.next(name)) {
+			const ECMAProperyInfo &prop = cls->properties.get(*name);
+			const ECMAProperyInfo *old_prop = p_old_properties.getptr(*name);
+			if (!p_keep_state || old_prop == NULL || old_prop->type != prop.type) {
+				binding->set_instance_property(instance->ecma_object, *name, prop.default_value);
+			}
+		}
+	}
+	update_exports();
 }
 
 bool ECMAScript::instance_has(const Object *p_this) const {
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_singleton()->binding);
 	return instances.has(const_cast<Object *>(p_this));
 }
 
@@ -99,7 +127,7 @@ bool ECMAScript::has_method(const StringName &p_method) const {
 	ECMAClassInfo *cls = get_ecma_class();
 	ERR_FAIL_NULL_V(cls, false);
 
-	return cls->methods.has(p_method);
+	return cls->find_method(p_method) != NULL;
 }
 
 MethodInfo ECMAScript::get_method_info(const StringName &p_method) const {
@@ -76,6 +76,8 @@ public:
 	_FORCE_INLINE_ Ref<ECMAScriptLibrary> get_library() const { return library; }
 
 	ECMAClassInfo *get_ecma_class() const;
+	// Called after the class was registered again by its reloaded library
+	void rebind_instances(const HashMap<StringName, ECMAProperyInfo> &p_old_properties, bool p_keep_state);
 
 	ECMAScript();
 	~ECMAScript();
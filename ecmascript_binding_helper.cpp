@@ -0,0 +1,92 @@
+#include "ecmascript_binding_helper.h"
+
+StringName ECMAScriptBindingHelper::virtual_method_names[ECMA_VIRTUAL_MAX];
+
+void ECMAScriptBindingHelper::init_virtual_method_names() {
+	virtual_method_names[ECMA_VIRTUAL_NOTIFICATION] = StaticCString::create("_notification");
+	virtual_method_names[ECMA_VIRTUAL_READY] = StaticCString::create("_ready");
+	virtual_method_names[ECMA_VIRTUAL_ENTER_TREE] = StaticCString::create("_enter_tree");
+	virtual_method_names[ECMA_VIRTUAL_EXIT_TREE] = StaticCString::create("_exit_tree");
+	virtual_method_names[ECMA_VIRTUAL_PROCESS] = StaticCString::create("_process");
+	virtual_method_names[ECMA_VIRTUAL_PHYSICS_PROCESS] = StaticCString::create("_physics_process");
+	virtual_method_names[ECMA_VIRTUAL_INPUT] = StaticCString::create("_input");
+	virtual_method_names[ECMA_VIRTUAL_UNHANDLED_INPUT] = StaticCString::create("_unhandled_input");
+	virtual_method_names[ECMA_VIRTUAL_UNHANDLED_KEY_INPUT] = StaticCString::create("_unhandled_key_input");
+	virtual_method_names[ECMA_VIRTUAL_DRAW] = StaticCString::create("_draw");
+}
+
+void ECMAScriptBindingHelper::clear_virtual_method_names() {
+	for (int i = 0; i < ECMA_VIRTUAL_MAX; ++i) {
+		virtual_method_names[i] = StringName();
+	}
+}
+
+uint32_t ECMAScriptBindingHelper::get_virtual_methods(const HashMap<StringName, ECMAMethodInfo> &p_methods) {
+	uint32_t mask = 0;
+	for (int i = 0; i < ECMA_VIRTUAL_MAX; ++i) {
+		if (p_methods.has(virtual_method_names[i])) {
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+void ECMAMethodTable::grow() {
+
+	Entry *old_entries = entries;
+	const uint32_t old_capacity = capacity;
+
+	if (capacity == 0 || capacity >= MAX_CAPACITY) {
+		// Start over when full, a flood of unknown names must not grow the table without bound
+		capacity = INITIAL_CAPACITY;
+		used = 0;
+		entries = memnew_arr(Entry, capacity);
+		if (old_entries) {
+			memdelete_arr(old_entries);
+		}
+		return;
+	}
+
+	capacity = old_capacity * 2;
+	entries = memnew_arr(Entry, capacity);
+	for (uint32_t i = 0; i < old_capacity; ++i) {
+		const Entry &e = old_entries[i];
+		if (e.name.data_unique_pointer() == NULL) continue;
+		uint32_t pos = e.name.hash() & (capacity - 1);
+		while (entries[pos].name.data_unique_pointer()) {
+			pos = (pos + 1) & (capacity - 1);
+		}
+		entries[pos] = e;
+	}
+	memdelete_arr(old_entries);
+}
+
+const ECMAMethodInfo *ECMAMethodTable::insert(const StringName &p_name, const ECMAMethodInfo *p_method) {
+
+	if (p_name.data_unique_pointer() == NULL) {
+		return p_method;
+	}
+
+	// Keep the load factor below one half so probe sequences stay short
+	if ((used + 1) * 2 > capacity) {
+		grow();
+	}
+
+	uint32_t pos = p_name.hash() & (capacity - 1);
+	while (entries[pos].name.data_unique_pointer()) {
+		pos = (pos + 1) & (capacity - 1);
+	}
+	entries[pos].name = p_name;
+	entries[pos].method = p_method;
+	++used;
+	return p_method;
+}
+
+void ECMAMethodTable::clear() {
+	if (entries) {
+		memdelete_arr(entries);
+	}
+	entries = NULL;
+	capacity = 0;
+	used = 0;
+}
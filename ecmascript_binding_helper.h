@@ -3,6 +3,7 @@
 
 #include "core/object.h"
 #include "core/reference.h"
+#include "core/script_language.h"
 
 #define PROTOTYPE_LITERAL "prototype"
 #define PROTO_LITERAL "__proto__"
@@ -25,25 +26,134 @@ struct ECMAProperyInfo {
 	Variant default_value;
 };
 
+/**
+ * Open addressing table resolving method names by their interned StringName pointer.
+ * Names the class doesn't define are cached as well, so engine callbacks a script doesn't implement miss in O(1).
+ * Copies start empty and fill up again on lookup. Lookups write the table, callers hold the lock of the binding.
+ */
+class ECMAMethodTable {
+
+	enum {
+		INITIAL_CAPACITY = 16,
+		MAX_CAPACITY = 1024,
+	};
+
+	struct Entry {
+		StringName name; // keeps the interned name alive while its pointer is a key
+		const ECMAMethodInfo *method;
+	};
+
+	Entry *entries;
+	uint32_t capacity;
+	uint32_t used;
+
+	void grow();
+
+public:
+	_FORCE_INLINE_ const ECMAMethodInfo *lookup(const StringName &p_name, const HashMap<StringName, ECMAMethodInfo> &p_methods) {
+		const void *key = p_name.data_unique_pointer();
+		if (entries && key) {
+			for (uint32_t i = p_name.hash() & (capacity - 1);; i = (i + 1) & (capacity - 1)) {
+				const Entry &e = entries[i];
+				if (e.name.data_unique_pointer() == key) {
+					return e.method;
+				} else if (e.name.data_unique_pointer() == NULL) {
+					break;
+				}
+			}
+		}
+		return insert(p_name, p_methods.getptr(p_name));
+	}
+
+	const ECMAMethodInfo *insert(const StringName &p_name, const ECMAMethodInfo *p_method);
+	void clear();
+
+	ECMAMethodTable() :
+			entries(NULL),
+			capacity(0),
+			used(0) {}
+	ECMAMethodTable(const ECMAMethodTable &) :
+			entries(NULL),
+			capacity(0),
+			used(0) {}
+	ECMAMethodTable &operator=(const ECMAMethodTable &) {
+		clear();
+		return *this;
+	}
+	~ECMAMethodTable() { clear(); }
+};
+
+// Engine callbacks tracked per class in ECMAClassInfo::virtual_methods
+enum ECMAVirtualMethod {
+	ECMA_VIRTUAL_NOTIFICATION,
+	ECMA_VIRTUAL_READY,
+	ECMA_VIRTUAL_ENTER_TREE,
+	ECMA_VIRTUAL_EXIT_TREE,
+	ECMA_VIRTUAL_PROCESS,
+	ECMA_VIRTUAL_PHYSICS_PROCESS,
+	ECMA_VIRTUAL_INPUT,
+	ECMA_VIRTUAL_UNHANDLED_INPUT,
+	ECMA_VIRTUAL_UNHANDLED_KEY_INPUT,
+	ECMA_VIRTUAL_DRAW,
+	ECMA_VIRTUAL_MAX,
+};
+
 struct ECMAClassInfo {
 	ECMAScriptGCHandler ecma_constructor;
 	StringName class_name;
 	String icon_path;
 	bool tool;
 	ClassDB::ClassInfo *native_class;
+	StringName base_class; // nearest script class this class extends, empty when it extends a native class
 	HashMap<StringName, ECMAMethodInfo> methods;
 	HashMap<StringName, MethodInfo> signals;
 	HashMap<StringName, ECMAProperyInfo> properties;
+	ECMAMethodTable method_table;
+	uint32_t virtual_methods; // bit set of the ECMAVirtualMethod callbacks the class implements
+
+	_FORCE_INLINE_ const ECMAMethodInfo *find_method(const StringName &p_name) { return method_table.lookup(p_name, methods); }
+	_FORCE_INLINE_ bool implements(ECMAVirtualMethod p_method) const { return virtual_methods & (1 << p_method); }
 };
 
 class ECMAScriptBindingHelper {
 	friend class ECMAScript;
 
+	static StringName virtual_method_names[ECMA_VIRTUAL_MAX];
+
 protected:
 	HashMap<StringName, ECMAClassInfo> ecma_classes;
+	// changes whenever classes are registered or cleared, pointers to ECMAClassInfo cached with an older value are stale
+	uint32_t class_generation;
+
+	_FORCE_INLINE_ void set_class(const StringName &p_name, const ECMAClassInfo &p_class) {
+		ecma_classes.set(p_name, p_class);
+		++class_generation;
+	}
 
 public:
-	virtual void clear_classes() { ecma_classes.clear(); }
+	virtual void clear_classes() {
+		ecma_classes.clear();
+		++class_generation;
+	}
+
+	static void init_virtual_method_names();
+	static void clear_virtual_method_names();
+	static uint32_t get_virtual_methods(const HashMap<StringName, ECMAMethodInfo> &p_methods);
+
+	_FORCE_INLINE_ static const StringName &get_virtual_method_name(ECMAVirtualMethod p_method) { return virtual_method_names[p_method]; }
+	// Returns the ECMAVirtualMethod named p_name, or -1 for other names
+	_FORCE_INLINE_ static int get_virtual_method(const StringName &p_name) {
+		for (int i = 0; i < ECMA_VIRTUAL_MAX; ++i) {
+			if (virtual_method_names[i] == p_name) return i;
+		}
+		return -1;
+	}
+
+	_FORCE_INLINE_ uint32_t get_class_generation() const { return class_generation; }
+	_FORCE_INLINE_ ECMAClassInfo *get_class(const StringName &p_name) { return ecma_classes.getptr(p_name); }
+
+	ECMAScriptBindingHelper() :
+			class_generation(0) {}
 
 	virtual void initialize() = 0;
 	virtual void uninitialize() = 0;
@@ -57,10 +167,41 @@ public:
 	virtual Error eval_string(const String &p_source) = 0;
 	virtual Error safe_eval_text(const String &p_source, String &r_error) = 0;
 
+	// Precompiled code, only valid for the engine build that reports the same bytecode version
+	virtual uint32_t get_bytecode_version() const = 0;
+	virtual Error compile_to_bytecode(const String &p_source, const String &p_path, Vector<uint8_t> &r_bytecode) = 0;
+	virtual Error eval_bytecode(const Vector<uint8_t> &p_bytecode) = 0;
+
 	virtual ECMAScriptGCHandler create_ecma_instance_for_godot_object(const StringName &ecma_class_name, Object *p_object) = 0;
 	virtual Variant call_method(const ECMAScriptGCHandler &p_object, const ECMAMethodInfo &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error) = 0;
 	virtual bool get_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, Variant &r_ret) = 0;
 	virtual bool set_instance_property(const ECMAScriptGCHandler &p_object, const StringName &p_name, const Variant &p_value) = 0;
+	// Points an existing instance to the prototype of a reloaded class
+	virtual void rebind_instance(const ECMAScriptGCHandler &p_object, const ECMAClassInfo &p_class) = 0;
+	// Called once per main loop iteration
+	virtual void frame() = 0;
+	// Called by engine threads before and after they may run scripts
+	virtual void thread_enter() = 0;
+	virtual void thread_exit() = 0;
+	// Recursive lock of the script heap, held while instances of engine threads use the class tables
+	virtual void lock() = 0;
+	virtual void unlock() = 0;
+
+	class Lock {
+		ECMAScriptBindingHelper *binding;
+
+	public:
+		_FORCE_INLINE_ Lock(ECMAScriptBindingHelper *p_binding) :
+				binding(p_binding) {
+			binding->lock();
+		}
+		_FORCE_INLINE_ ~Lock() { binding->unlock(); }
+	};
+	// Script functions shown in the profiler of the editor, -1 if profiling isn't supported by the build
+	virtual void profiling_start() = 0;
+	virtual void profiling_stop() = 0;
+	virtual int profiling_get_accumulated_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) = 0;
+	virtual int profiling_get_frame_data(ScriptLanguage::ProfilingInfo *p_info_arr, int p_info_max) = 0;
 };
 
 #endif
@@ -12,13 +12,32 @@ void ECMAScriptInstance::get_method_list(List<MethodInfo> *p_list) const {
 }
 
 bool ECMAScriptInstance::has_method(const StringName &p_method) const {
-	ERR_FAIL_COND_V(script.is_null(), false);
-	return script->has_method(p_method);
+	// The engine probes callbacks like _process when entering the tree, answer those from the class mask
+	const int virtual_method = ECMAScriptBindingHelper::get_virtual_method(p_method);
+	if (virtual_method >= 0 && is_ecma_class_cached()) {
+		return ecma_class && ecma_class->implements(ECMAVirtualMethod(virtual_method));
+	}
+
+	// Engine threads call in as well, the class cache and the method table are filled on lookup
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
+	ECMAClassInfo *cls = get_ecma_class();
+	ERR_FAIL_NULL_V(cls, false);
+	if (virtual_method >= 0) {
+		return cls->implements(ECMAVirtualMethod(virtual_method));
+	}
+	return cls->find_method(p_method) != NULL;
+}
+
+ECMAClassInfo *ECMAScriptInstance::resolve_ecma_class() const {
+	ecma_class = script.is_null() ? NULL : script->get_ecma_class();
+	ecma_class_generation = ECMAScriptLanguage::get_binder()->get_class_generation();
+	return ecma_class;
 }
 
 bool ECMAScriptInstance::set(const StringName &p_name, const Variant &p_value) {
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
 	if(!script.is_null()) {
-		if (ECMAClassInfo * cls = script->get_ecma_class()) {
+		if (ECMAClassInfo * cls = get_ecma_class()) {
 			if(ECMAProperyInfo * pi = cls->properties.getptr(p_name)) {
 				return ECMAScriptLanguage::get_singleton()->binding->set_instance_property(this->ecma_object, p_name, p_value);
 			}
@@ -28,8 +47,9 @@ bool ECMAScriptInstance::set(const StringName &p_name, const Variant &p_value) {
 }
 
 bool ECMAScriptInstance::get(const StringName &p_name, Variant &r_ret) const {
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
 	if(!script.is_null()) {
-		if (ECMAClassInfo * cls = script->get_ecma_class()) {
+		if (ECMAClassInfo * cls = get_ecma_class()) {
 			if(ECMAProperyInfo * pi = cls->properties.getptr(p_name)) {
 				return ECMAScriptLanguage::get_singleton()->binding->get_instance_property(this->ecma_object, p_name, r_ret);
 			}
@@ -45,8 +65,9 @@ void ECMAScriptInstance::get_property_list(List<PropertyInfo> *p_properties) con
 
 Variant::Type ECMAScriptInstance::get_property_type(const StringName &p_name, bool *r_is_valid) const {
 	*r_is_valid = false;
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
 	if(!script.is_null()) {
-		if (ECMAClassInfo * cls = script->get_ecma_class()) {
+		if (ECMAClassInfo * cls = get_ecma_class()) {
 			if(ECMAProperyInfo * pi = cls->properties.getptr(p_name)) {
 				*r_is_valid = true;
 				return pi->type;
@@ -60,13 +81,20 @@ Variant ECMAScriptInstance::call(const StringName &p_method, const Variant **p_a
 
 	ERR_FAIL_COND_V(script.is_null() || ecma_object.is_null(), Variant());
 
-	ECMAClassInfo *cls = script->get_ecma_class();
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
+	ECMAClassInfo *cls = get_ecma_class();
 	if (cls == NULL) {
 		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 		return Variant();
 	}
 
-	ECMAMethodInfo *method = cls->methods.getptr(p_method);
+	const int virtual_method = ECMAScriptBindingHelper::get_virtual_method(p_method);
+	if (virtual_method >= 0 && !cls->implements(ECMAVirtualMethod(virtual_method))) {
+		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
+		return Variant();
+	}
+
+	const ECMAMethodInfo *method = cls->find_method(p_method);
 	if (method == NULL) {
 		r_error.error = Variant::CallError::CALL_ERROR_INVALID_METHOD;
 		return Variant();
@@ -75,6 +103,28 @@ Variant ECMAScriptInstance::call(const StringName &p_method, const Variant **p_a
 	return ECMAScriptLanguage::get_singleton()->binding->call_method(ecma_object, *method, p_args, p_argcount, r_error);
 }
 
+void ECMAScriptInstance::notification(int p_notification) {
+
+	// Most classes don't handle notifications, skip the lock for them
+	if (is_ecma_class_cached() && (ecma_class == NULL || !ecma_class->implements(ECMA_VIRTUAL_NOTIFICATION))) {
+		return;
+	}
+
+	ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
+	ECMAClassInfo *cls = get_ecma_class();
+	if (cls == NULL || !cls->implements(ECMA_VIRTUAL_NOTIFICATION) || ecma_object.is_null()) {
+		return;
+	}
+
+	const ECMAMethodInfo *method = cls->find_method(ECMAScriptBindingHelper::get_virtual_method_name(ECMA_VIRTUAL_NOTIFICATION));
+	ERR_FAIL_NULL(method);
+
+	Variant what = p_notification;
+	const Variant *args[1] = { &what };
+	Variant::CallError err;
+	ECMAScriptLanguage::get_singleton()->binding->call_method(ecma_object, *method, args, 1, err);
+}
+
 ScriptLanguage *ECMAScriptInstance::get_language() {
 	return ECMAScriptLanguage::get_singleton();
 }
@@ -82,7 +132,13 @@ ScriptLanguage *ECMAScriptInstance::get_language() {
 ECMAScriptInstance::ECMAScriptInstance() {
 	owner = NULL;
 	ecma_object.ecma_object = NULL;
+	ecma_class = NULL;
+	ecma_class_generation = 0;
 }
 
 ECMAScriptInstance::~ECMAScriptInstance() {
+	if (script.is_valid() && owner) {
+		ECMAScriptBindingHelper::Lock lock(ECMAScriptLanguage::get_binder());
+		script->instances.erase(owner);
+	}
 }
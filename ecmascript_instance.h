@@ -3,6 +3,7 @@
 
 #include "ecmascript.h"
 #include "ecmascript_binding_helper.h"
+#include "ecmascript_language.h"
 #include <core/script_language.h>
 
 class ECMAScriptInstance : public ScriptInstance {
@@ -14,6 +15,22 @@ class ECMAScriptInstance : public ScriptInstance {
 	Ref<ECMAScript> script;
 	ECMAScriptGCHandler ecma_object;
 
+	// class info of the script, resolved again after classes are reloaded
+	mutable ECMAClassInfo *ecma_class;
+	mutable uint32_t ecma_class_generation;
+
+	ECMAClassInfo *resolve_ecma_class() const;
+	_FORCE_INLINE_ ECMAClassInfo *get_ecma_class() const {
+		if (ecma_class_generation != ECMAScriptLanguage::get_binder()->get_class_generation()) {
+			return resolve_ecma_class();
+		}
+		return ecma_class;
+	}
+	// Answers from a current cache without the binding lock, the mask of the class is read only
+	_FORCE_INLINE_ bool is_ecma_class_cached() const {
+		return ecma_class_generation == ECMAScriptLanguage::get_binder()->get_class_generation();
+	}
+
 public:
 	virtual bool set(const StringName &p_name, const Variant &p_value);
 	virtual bool get(const StringName &p_name, Variant &r_ret) const;
@@ -28,7 +45,7 @@ public:
 
 	virtual Variant call(const StringName &p_method, const Variant **p_args, int p_argcount, Variant::CallError &r_error);
 
-	/* TODO */ virtual void notification(int p_notification) {}
+	virtual void notification(int p_notification);
 
 	//this is used by script languages that keep a reference counter of their own
 	//you can make make Ref<> not die when it reaches zero, so deleting the reference
@@ -1,6 +1,7 @@
 #include "ecmascript_language.h"
 #include "core/class_db.h"
 #include "core/os/file_access.h"
+#include "core/project_settings.h"
 
 ECMAScriptLanguage *ECMAScriptLanguage::singleton = NULL;
 
@@ -13,11 +14,15 @@ void ECMAScriptLanguage::get_registered_classes(List<Ref<ECMAScript> > &r_list)
 void ECMAScriptLanguage::init() {
 	ERR_FAIL_NULL(binding);
 
+	GLOBAL_DEF("ecmascript/bytecode_cache", true);
+
+	ECMAScriptBindingHelper::init_virtual_method_names();
 	binding->initialize();
 }
 
 void ECMAScriptLanguage::finish() {
 	binding->uninitialize();
+	ECMAScriptBindingHelper::clear_virtual_method_names();
 }
 
 Error ECMAScriptLanguage::execute_file(const String &p_path) {
@@ -47,6 +52,56 @@ Error ECMAScriptLanguage::safe_eval_text(const String &p_source, String &err) {
 	return binding->safe_eval_text(p_source, err);
 }
 
+uint32_t ECMAScriptLanguage::get_bytecode_version() const {
+	ERR_FAIL_NULL_V(binding, 0);
+	return binding->get_bytecode_version();
+}
+
+Error ECMAScriptLanguage::compile_to_bytecode(const String &p_source, const String &p_path, Vector<uint8_t> &r_bytecode) {
+	ERR_FAIL_NULL_V(binding, ERR_BUG);
+	return binding->compile_to_bytecode(p_source, p_path, r_bytecode);
+}
+
+Error ECMAScriptLanguage::eval_bytecode(const Vector<uint8_t> &p_bytecode) {
+	ERR_FAIL_NULL_V(binding, ERR_BUG);
+	return binding->eval_bytecode(p_bytecode);
+}
+
+void ECMAScriptLanguage::thread_enter() {
+	ERR_FAIL_NULL(binding);
+	binding->thread_enter();
+}
+
+void ECMAScriptLanguage::thread_exit() {
+	ERR_FAIL_NULL(binding);
+	binding->thread_exit();
+}
+
+void ECMAScriptLanguage::profiling_start() {
+	ERR_FAIL_NULL(binding);
+	binding->profiling_start();
+}
+
+void ECMAScriptLanguage::profiling_stop() {
+	ERR_FAIL_NULL(binding);
+	binding->profiling_stop();
+}
+
+int ECMAScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) {
+	ERR_FAIL_NULL_V(binding, -1);
+	return binding->profiling_get_accumulated_data(p_info_arr, p_info_max);
+}
+
+int ECMAScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) {
+	ERR_FAIL_NULL_V(binding, -1);
+	return binding->profiling_get_frame_data(p_info_arr, p_info_max);
+}
+
+void ECMAScriptLanguage::frame() {
+	ERR_FAIL_NULL(binding);
+	binding->frame();
+}
+
 void ECMAScriptLanguage::get_reserved_words(List<String> *p_words) const {
 
 	static const char *_reserved_words[] = {
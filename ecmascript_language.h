@@ -52,6 +52,9 @@ public:
 	virtual Error execute_file(const String &p_path);
 	Error eval_text(const String &p_source);
 	Error safe_eval_text(const String &p_source, String &r_err);
+	uint32_t get_bytecode_version() const;
+	Error compile_to_bytecode(const String &p_source, const String &p_path, Vector<uint8_t> &r_bytecode);
+	Error eval_bytecode(const Vector<uint8_t> &p_bytecode);
 
 	virtual void get_reserved_words(List<String> *p_words) const;
 	virtual void get_comment_delimiters(List<String> *p_delimiters) const;
@@ -78,8 +81,8 @@ public:
 	/* MULTITHREAD FUNCTIONS */
 
 	//some VMs need to be notified of thread creation/exiting to allocate a stack
-	/* TODO */ virtual void thread_enter() {}
-	/* TODO */ virtual void thread_exit() {}
+	virtual void thread_enter();
+	virtual void thread_exit();
 
 	/* DEBUGGER FUNCTIONS */
 
@@ -103,18 +106,18 @@ public:
 	/* TODO */ virtual void get_public_functions(List<MethodInfo> *p_functions) const {}
 	/* TODO */ virtual void get_public_constants(List<Pair<String, Variant> > *p_constants) const {}
 
-	/* TODO */ virtual void profiling_start() {}
-	/* TODO */ virtual void profiling_stop() {}
+	virtual void profiling_start();
+	virtual void profiling_stop();
 
-	/* TODO */ virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) { return -1; }
-	/* TODO */ virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) { return -1; }
+	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max);
+	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max);
 
 	virtual void *alloc_instance_binding_data(Object *p_object); //optional, not used by all languages
 	virtual void free_instance_binding_data(void *p_data); //optional, not used by all languages
 	virtual void refcount_incremented_instance_binding(Object *p_object); //optional, not used by all languages
 	virtual bool refcount_decremented_instance_binding(Object *p_object); //return true if it can die //optional, not used by all languages
 
-	/* TODO */ virtual void frame(){};
+	virtual void frame();
 
 	/* TODO */ virtual bool handles_global_class_type(const String &p_type) const { return false; }
 	/* TODO */ virtual String get_global_class_name(const String &p_path, String *r_base_type = NULL, String *r_icon_path = NULL) const { return String(); }
@@ -1,5 +1,8 @@
 #include "ecmascript_library.h"
+#include "core/io/marshalls.h"
+#include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/project_settings.h"
 #include "ecmascript_language.h"
 #include "scene/resources/text_file.h"
 #include "core/engine.h"
@@ -55,8 +58,8 @@ void ECMAScriptLibraryResourceLoader::reload_cached_libs() {
 
 	for (Set<ObjectID>::Element * E = ecma_libs.front(); E; E = E->next()) {
 		ECMAScriptLibrary *lib = Object::cast_to<ECMAScriptLibrary>(ObjectDB::get_instance(E->get()));
-		if (lib) {
-			lib->reload_from_file();
+		if (lib && OK == lib->load_text(lib->get_path())) {
+			lib->eval_text();
 		}
 	}
 }
@@ -85,9 +88,65 @@ void ECMAScriptLibraryResourceSaver::get_recognized_extensions(const RES &p_reso
 	}
 }
 
+Error ECMAScriptLibraryResourceLoader::reload_library(const Ref<ECMAScriptLibrary> &p_library, bool p_keep_state) {
+
+	ERR_FAIL_COND_V(p_library.is_null(), ERR_INVALID_PARAMETER);
+	ECMAScriptLanguage *language = ECMAScriptLanguage::get_singleton();
+
+	List<Ref<ECMAScript> > scripts;
+	language->get_registered_classes(scripts);
+
+	// The changed library comes first, followed by the libraries with classes extending the classes of an earlier one
+	Vector<Ref<ECMAScriptLibrary> > libs;
+	libs.push_back(p_library);
+	for (int i = 0; i < libs.size(); ++i) {
+		for (List<Ref<ECMAScript> >::Element *E = scripts.front(); E; E = E->next()) {
+			const Ref<ECMAScript> &script = E->get();
+			const ECMAClassInfo *cls = script->get_ecma_class();
+			if (cls == NULL || cls->base_class == StringName() || script->get_library().is_null() || libs.find(script->get_library()) != -1) {
+				continue;
+			}
+			const Ref<ECMAScript> *base = language->get_class_script_ptr(cls->base_class);
+			if (base && (*base)->get_library() == libs[i]) {
+				libs.push_back(script->get_library());
+			}
+		}
+	}
+
+	HashMap<StringName, HashMap<StringName, ECMAProperyInfo> > old_properties;
+	for (List<Ref<ECMAScript> >::Element *E = scripts.front(); E; E = E->next()) {
+		const ECMAClassInfo *cls = E->get()->get_ecma_class();
+		if (cls && libs.find(E->get()->get_library()) != -1) {
+			old_properties.set(cls->class_name, cls->properties);
+		}
+	}
+
+	Error err = OK;
+	for (int i = 0; i < libs.size(); ++i) {
+		Error lib_err = libs[i]->eval_text();
+		if (lib_err != OK) {
+			err = lib_err;
+		}
+	}
+
+	// Classes that are gone after the reload keep their instances as they are
+	for (const StringName *name = old_properties.next(NULL); name; name = old_properties.next(name)) {
+		const Ref<ECMAScript> *script = language->get_class_script_ptr(*name);
+		if (script && (*script)->get_ecma_class()) {
+			(*script)->rebind_instances(old_properties.get(*name), p_keep_state);
+		}
+	}
+	return err;
+}
+
 void ECMAScriptLibrary::reload_from_file() {
-	TextFile::reload_from_file();
-	eval_text();
+	reload(true);
+}
+
+Error ECMAScriptLibrary::reload(bool p_keep_state) {
+	Error err = load_text(get_path());
+	ERR_FAIL_COND_V(err != OK, err);
+	return ECMAScriptLibraryResourceLoader::reload_library(Ref<ECMAScriptLibrary>(this), p_keep_state);
 }
 
 Error ECMAScriptLibrary::eval_text() {
@@ -99,9 +158,126 @@ Error ECMAScriptLibrary::eval_text() {
 		if (OK != err) {
 			ERR_EXPLAIN(err_msg);
 		}
+	} else if (GLOBAL_GET("ecmascript/bytecode_cache")) {
+		err = eval_cached_bytecode();
 	} else {
 		err = ECMAScriptLanguage::get_singleton()->eval_text(get_text());
 	}
 	ECMAScriptLibraryResourceLoader::loading_lib = RES();
 	return err;
 }
+
+/**
+ * Bytecode file layout, integers are little endian:
+ *   "ECBC" | format version | engine bytecode version | MD5 of the UTF-8 source (16 bytes) | size | bytecode
+ * A file is only used when every header field matches, so edited sources and engine upgrades fall back to
+ * compiling the source.
+ */
+#define ECMA_BYTECODE_MAGIC "ECBC"
+#define ECMA_BYTECODE_FORMAT_VERSION 2 // 2: libraries are compiled with the module wrapper
+#define ECMA_BYTECODE_HASH_SIZE 16
+
+String ECMAScriptLibrary::get_bytecode_cache_path(const String &p_path) {
+	return "user://ecmascript/bytecode/" + p_path.md5_text() + ".jsc";
+}
+
+Error ECMAScriptLibrary::load_bytecode(const String &p_file, const String &p_source, Vector<uint8_t> &r_bytecode) {
+
+	if (!FileAccess::exists(p_file)) {
+		return ERR_FILE_NOT_FOUND;
+	}
+	FileAccessRef file = FileAccess::open(p_file, FileAccess::READ);
+	if (!file) {
+		return ERR_FILE_CANT_OPEN;
+	}
+
+	uint8_t magic[4];
+	if (file->get_buffer(magic, 4) != 4 || memcmp(magic, ECMA_BYTECODE_MAGIC, 4) != 0) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+	if (file->get_32() != ECMA_BYTECODE_FORMAT_VERSION || file->get_32() != ECMAScriptLanguage::get_singleton()->get_bytecode_version()) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	uint8_t hash[ECMA_BYTECODE_HASH_SIZE];
+	Vector<uint8_t> source_hash = p_source.md5_buffer();
+	ERR_FAIL_COND_V(source_hash.size() != ECMA_BYTECODE_HASH_SIZE, ERR_BUG);
+	if (file->get_buffer(hash, ECMA_BYTECODE_HASH_SIZE) != ECMA_BYTECODE_HASH_SIZE || memcmp(hash, source_hash.ptr(), ECMA_BYTECODE_HASH_SIZE) != 0) {
+		return ERR_FILE_MISMATCH;
+	}
+
+	const uint32_t size = file->get_32();
+	if (size == 0 || size != file->get_len() - file->get_position()) {
+		return ERR_FILE_CORRUPT;
+	}
+	r_bytecode.resize(size);
+	if (file->get_buffer(r_bytecode.ptrw(), size) != int(size)) {
+		r_bytecode.clear();
+		return ERR_FILE_CORRUPT;
+	}
+	return OK;
+}
+
+Vector<uint8_t> ECMAScriptLibrary::encode_bytecode(const String &p_source, const Vector<uint8_t> &p_bytecode) {
+
+	Vector<uint8_t> source_hash = p_source.md5_buffer();
+	ERR_FAIL_COND_V(source_hash.size() != ECMA_BYTECODE_HASH_SIZE, Vector<uint8_t>());
+
+	const int header_size = 4 + 4 + 4 + ECMA_BYTECODE_HASH_SIZE + 4;
+	Vector<uint8_t> data;
+	data.resize(header_size + p_bytecode.size());
+	uint8_t *w = data.ptrw();
+	copymem(w, ECMA_BYTECODE_MAGIC, 4);
+	encode_uint32(ECMA_BYTECODE_FORMAT_VERSION, w + 4);
+	encode_uint32(ECMAScriptLanguage::get_singleton()->get_bytecode_version(), w + 8);
+	copymem(w + 12, source_hash.ptr(), ECMA_BYTECODE_HASH_SIZE);
+	encode_uint32(p_bytecode.size(), w + 12 + ECMA_BYTECODE_HASH_SIZE);
+	copymem(w + header_size, p_bytecode.ptr(), p_bytecode.size());
+	return data;
+}
+
+Error ECMAScriptLibrary::save_bytecode(const String &p_file, const String &p_source, const Vector<uint8_t> &p_bytecode) {
+
+	Vector<uint8_t> data = encode_bytecode(p_source, p_bytecode);
+	ERR_FAIL_COND_V(data.empty(), ERR_BUG);
+
+	DirAccessRef dir = DirAccess::create_for_path(p_file.get_base_dir());
+	if (!dir->dir_exists(p_file.get_base_dir())) {
+		Error err = dir->make_dir_recursive(p_file.get_base_dir());
+		ERR_FAIL_COND_V(err != OK, err);
+	}
+
+	FileAccessRef file = FileAccess::open(p_file, FileAccess::WRITE);
+	ERR_FAIL_COND_V(!file, ERR_FILE_CANT_WRITE);
+
+	file->store_buffer(data.ptr(), data.size());
+	file->close();
+	return OK;
+}
+
+Error ECMAScriptLibrary::eval_cached_bytecode() {
+
+	ECMAScriptLanguage *language = ECMAScriptLanguage::get_singleton();
+	const String &source = get_text();
+	const String cache_path = get_bytecode_cache_path(get_path());
+	Vector<uint8_t> bytecode;
+
+	// Prefer the bytecode exported with the project, then the one compiled by a previous run
+	if (OK == load_bytecode(get_bytecode_path(get_path()), source, bytecode) || OK == load_bytecode(cache_path, source, bytecode)) {
+		Error err = language->eval_bytecode(bytecode);
+		if (err != ERR_FILE_CORRUPT) {
+			return err;
+		}
+	}
+
+	if (OK != language->compile_to_bytecode(source, get_path(), bytecode)) {
+		// Evaluate the source anyway so the error is reported like without the cache
+		return language->eval_text(source);
+	}
+
+	Error err = language->eval_bytecode(bytecode);
+	if (OK == err && OK != save_bytecode(cache_path, source, bytecode)) {
+		WARN_PRINTS("Failed to write the bytecode cache of " + get_path());
+	}
+	return err;
+}
@@ -7,11 +7,22 @@
 
 class ECMAScriptLibrary : public TextFile {
 	GDCLASS(ECMAScriptLibrary, TextFile)
+
+	Error eval_cached_bytecode();
+
 protected:
 	static void _bind_methods() {};
 public:
 	virtual void reload_from_file();
+	Error reload(bool p_keep_state);
 	Error eval_text();
+
+	// Bytecode files are shipped next to the library as `<path>c` or cached in the user data directory
+	_FORCE_INLINE_ static String get_bytecode_path(const String &p_path) { return p_path + "c"; }
+	static String get_bytecode_cache_path(const String &p_path);
+	static Error load_bytecode(const String &p_file, const String &p_source, Vector<uint8_t> &r_bytecode);
+	static Vector<uint8_t> encode_bytecode(const String &p_source, const Vector<uint8_t> &p_bytecode);
+	static Error save_bytecode(const String &p_file, const String &p_source, const Vector<uint8_t> &p_bytecode);
 };
 
 class ECMAScriptLibraryResourceLoader : public ResourceFormatLoader {
@@ -29,7 +40,8 @@ public:
 	virtual String get_resource_type(const String &p_path) const;
 
 	static Ref<ECMAScriptLibrary> get_loading_library() { return loading_lib; }
-	static void reload_cached_libs();;
+	static void reload_cached_libs();
+	static Error reload_library(const Ref<ECMAScriptLibrary> &p_library, bool p_keep_state);
 };
 
 class ECMAScriptLibraryResourceSaver : public ResourceFormatSaver {
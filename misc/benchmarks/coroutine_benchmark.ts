@@ -0,0 +1,65 @@
+import { gdclass } from "../decorators";
+
+@gdclass("PollingEntity")
+class PollingEntity extends godot.Node {
+
+	remaining = 3600;
+
+	_process(delta: number) {
+		this.remaining -= delta;
+		if (this.remaining <= 0) {
+			this.queue_free();
+		}
+	}
+}
+
+/**
+ * Per-frame cost of idle entities waiting for a timer: polled from `_process` versus suspended in coroutines.
+ *
+ * Attach to a node and run the scene, the average frame times are printed to the console.
+ */
+@gdclass("CoroutineBenchmark")
+export default class CoroutineBenchmark extends godot.Node {
+
+	entities = 5000;
+	frames = 120;
+
+	private frame = 0;
+	private start = 0;
+	private phase = 0;
+
+	_ready() {
+		this.begin_phase();
+	}
+
+	_process(delta: number) {
+		if (++this.frame < this.frames) return;
+
+		const elapsed = godot.OS.get_ticks_usec() - this.start;
+		const name = this.phase == 0 ? "polling" : "coroutines";
+		console.log(`  ${name}: ${(elapsed / this.frames / 1000).toFixed(3)} ms per frame with ${this.entities} idle entities`);
+
+		for (const child of this.get_children()) {
+			(child as godot.Node).queue_free();
+		}
+		if (++this.phase < 2) {
+			this.begin_phase();
+		} else {
+			this.set_process(false);
+		}
+	}
+
+	begin_phase() {
+		for (let i = 0; i < this.entities; i++) {
+			if (this.phase == 0) {
+				this.add_child(new PollingEntity());
+			} else {
+				godot.start_coroutine(() => {
+					godot.wait_seconds(3600);
+				});
+			}
+		}
+		this.frame = 0;
+		this.start = godot.OS.get_ticks_usec();
+	}
+}
@@ -0,0 +1,60 @@
+import { gdclass } from "../decorators";
+
+/**
+ * Integer-heavy workloads for comparing the default build with `ecmascript_fastint=yes`.
+ *
+ * Attach to a node and run the scene, the timings are printed to the console.
+ */
+@gdclass("FastintBenchmark")
+export default class FastintBenchmark extends godot.Node {
+
+	iterations = 1000000;
+
+	_ready() {
+		const int_mark = godot.get_type(godot.as_int(1)) === godot.TYPE_INT;
+		console.log(`fastint: ${int_mark ? "enabled" : "disabled"}, ${this.iterations} iterations`);
+
+		this.measure("integer arithmetic", () => {
+			let sum = 0;
+			for (let i = 0; i < this.iterations; i++) {
+				sum = (sum + i * 3) % 65521;
+			}
+			return sum;
+		});
+
+		this.measure("array indexing", () => {
+			const table: number[] = [];
+			for (let i = 0; i < 1024; i++) {
+				table.push(i);
+			}
+			let sum = 0;
+			for (let i = 0; i < this.iterations; i++) {
+				sum += table[i & 1023];
+			}
+			return sum;
+		});
+
+		this.measure("engine calls with int arguments", () => {
+			let sum = 0;
+			for (let i = 0; i < this.iterations / 10; i++) {
+				sum += godot.wrapi(i, 0, 360);
+			}
+			return sum;
+		});
+
+		this.measure("int round trip through engine", () => {
+			const arr = new godot.PoolIntArray();
+			for (let i = 0; i < this.iterations / 10; i++) {
+				arr.push_back(godot.as_int(i / 2));
+			}
+			return arr.size();
+		});
+	}
+
+	measure(name: string, task: () => number) {
+		const start = godot.OS.get_ticks_usec();
+		const result = task();
+		const elapsed = godot.OS.get_ticks_usec() - start;
+		console.log(`  ${name}: ${(elapsed / 1000).toFixed(2)} ms (result ${result})`);
+	}
+}
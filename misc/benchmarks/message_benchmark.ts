@@ -0,0 +1,95 @@
+import { gdclass } from "../decorators";
+
+interface MessageCase {
+	name: string;
+	bytes: number;
+	transfer: boolean;
+	make: () => any;
+}
+
+/**
+ * Throughput of structured clone messages with MB-sized payloads, copied and transferred.
+ *
+ * Compile `message_echo_worker.ts` next to this file and point `worker_script` to its output. The first part
+ * clones payloads within the main heap, the second part sends them to the worker and back. Round trips are
+ * completed from `frame()`, so they include up to one frame of latency.
+ */
+@gdclass("MessageBenchmark")
+export default class MessageBenchmark extends godot.Node {
+
+	worker_script = "res://benchmarks/message_echo_worker.js";
+	sizes = [1, 4, 16]; // MiB
+	rounds = 8;
+
+	private worker: godot.Worker;
+	private cases: MessageCase[] = [];
+	private current: MessageCase;
+	private pending = 0;
+	private start = 0;
+
+	_ready() {
+		for (const mib of this.sizes) {
+			const bytes = mib * 1024 * 1024;
+			this.cases.push({ name: `Float32Array ${mib} MiB`, bytes, transfer: false, make: () => new Float32Array(bytes / 4) });
+			this.cases.push({ name: `PoolByteArray ${mib} MiB`, bytes, transfer: false, make: () => this.make_pool(new godot.PoolByteArray(), bytes) });
+			this.cases.push({ name: `PoolByteArray ${mib} MiB transferred`, bytes, transfer: true, make: () => this.make_pool(new godot.PoolByteArray(), bytes) });
+			this.cases.push({ name: `PoolRealArray ${mib} MiB transferred`, bytes, transfer: true, make: () => this.make_pool(new godot.PoolRealArray(), bytes / 4) });
+			this.cases.push({ name: `PoolVector3Array ${mib} MiB transferred`, bytes, transfer: true, make: () => this.make_pool(new godot.PoolVector3Array(), bytes / 12) });
+		}
+
+		console.log("structured_clone:");
+		for (const c of this.cases) {
+			const payload = c.make();
+			const start = godot.OS.get_ticks_usec();
+			godot.structured_clone(payload, c.transfer ? [payload] : undefined);
+			this.report(c, godot.OS.get_ticks_usec() - start, 1);
+		}
+
+		console.log(`worker round trips, ${this.rounds} messages per case:`);
+		this.worker = new godot.Worker(this.worker_script);
+		this.worker.onmessage = (data: any) => this.on_reply(data);
+		this.next_case();
+	}
+
+	_exit_tree() {
+		if (this.worker) {
+			this.worker.terminate();
+		}
+	}
+
+	make_pool(pool: any, size: number) {
+		pool.resize(size);
+		return pool;
+	}
+
+	next_case() {
+		this.current = this.cases.shift();
+		if (!this.current) {
+			this.worker.terminate();
+			return;
+		}
+
+		const payloads = [];
+		for (let i = 0; i < this.rounds; i++) {
+			payloads.push(this.current.make());
+		}
+		this.pending = this.rounds;
+		this.start = godot.OS.get_ticks_usec();
+		for (const payload of payloads) {
+			this.worker.postMessage({ transfer: this.current.transfer, payload }, this.current.transfer ? [payload] : undefined);
+		}
+	}
+
+	on_reply(data: any) {
+		if (--this.pending > 0) {
+			return;
+		}
+		this.report(this.current, godot.OS.get_ticks_usec() - this.start, this.rounds * 2);
+		this.next_case();
+	}
+
+	report(c: MessageCase, usec: number, copies: number) {
+		const mib = c.bytes * copies / (1024 * 1024);
+		console.log(`  ${c.name}: ${(usec / 1000).toFixed(2)} ms, ${(mib / (usec / 1000000)).toFixed(0)} MiB/s`);
+	}
+}
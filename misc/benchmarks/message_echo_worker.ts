@@ -0,0 +1,9 @@
+/**
+ * Worker script of `MessageBenchmark`, posts every message back and transfers the payloads it received by transfer.
+ */
+declare function postMessage(data: any, transfer?: any[]): void;
+declare var onmessage: (data: any) => void;
+
+onmessage = function (data: any) {
+	postMessage(data, data.transfer ? [data.payload] : undefined);
+};
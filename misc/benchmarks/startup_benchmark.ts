@@ -0,0 +1,32 @@
+import { gdclass } from "../decorators";
+
+/**
+ * Startup cost of the `godot` namespace with lazy and eager class registration.
+ *
+ * Run the scene once with `ecmascript/lazy_class_registration` enabled and once disabled, the timings and
+ * memory usage are printed to the console. Memory usage is only measured by debug builds of the engine.
+ */
+@gdclass("StartupBenchmark")
+export default class StartupBenchmark extends godot.Node {
+
+	_ready() {
+		const stats = godot.get_startup_stats();
+		console.log(`lazy class registration: ${stats.lazy_class_registration ? "enabled" : "disabled"}`);
+		console.log(`  initialize: ${(stats.initialize_usec / 1000).toFixed(2)} ms, ${(stats.initialize_memory / 1024).toFixed(0)} KiB`);
+		console.log(`  classes created at ready: ${stats.created_classes} of ${stats.total_classes}`);
+
+		// Touch every class to get the cost of creating the ones that are still missing
+		const classes = godot.ClassDB.get_class_list();
+		const start_memory = godot.OS.get_static_memory_usage();
+		const start = godot.OS.get_ticks_usec();
+		let count = 0;
+		for (let i = 0; i < classes.size(); i++) {
+			if ((<any>godot)[classes.get(i)]) {
+				count++;
+			}
+		}
+		const elapsed = godot.OS.get_ticks_usec() - start;
+		const memory = godot.OS.get_static_memory_usage() - start_memory;
+		console.log(`  access all ${count} classes: ${(elapsed / 1000).toFixed(2)} ms, ${(memory / 1024).toFixed(0)} KiB`);
+	}
+}
@@ -0,0 +1,57 @@
+import { gdclass } from "../decorators";
+
+/**
+ * Cost of pending timers and promise chains.
+ *
+ * Attach to a node and run the scene. Thousands of far timers are scheduled first, the frame time should not
+ * grow with them. Then a burst of near timers and a long promise chain measure the dispatch cost.
+ */
+@gdclass("TimerBenchmark")
+export default class TimerBenchmark extends godot.Node {
+
+	pending_timers = 100000;
+	burst = 10000;
+	chain = 10000;
+	frames = 60;
+
+	private frame = 0;
+	private start = 0;
+
+	_ready() {
+		const start = godot.OS.get_ticks_usec();
+		for (let i = 0; i < this.pending_timers; i++) {
+			setTimeout(() => {}, 3600000 + i);
+		}
+		console.log(`  schedule ${this.pending_timers} timers: ${((godot.OS.get_ticks_usec() - start) / 1000).toFixed(2)} ms`);
+		this.start = godot.OS.get_ticks_usec();
+	}
+
+	_process(delta: number) {
+		if (++this.frame != this.frames) return;
+		const elapsed = godot.OS.get_ticks_usec() - this.start;
+		console.log(`  ${(elapsed / this.frames / 1000).toFixed(3)} ms per frame with ${this.pending_timers} pending timers`);
+		this.set_process(false);
+
+		let fired = 0;
+		const start = godot.OS.get_ticks_usec();
+		for (let i = 0; i < this.burst; i++) {
+			setTimeout(() => {
+				if (++fired == this.burst) {
+					console.log(`  ${this.burst} due timers: ${((godot.OS.get_ticks_usec() - start) / 1000).toFixed(2)} ms`);
+					this.run_chain();
+				}
+			}, 0);
+		}
+	}
+
+	run_chain() {
+		const start = godot.OS.get_ticks_usec();
+		let p = Promise.resolve(0);
+		for (let i = 0; i < this.chain; i++) {
+			p = p.then(v => v + 1);
+		}
+		p.then(v => {
+			console.log(`  promise chain of ${v}: ${((godot.OS.get_ticks_usec() - start) / 1000).toFixed(2)} ms`);
+		});
+	}
+}
@@ -30,6 +30,89 @@ declare module godot {
 	 */
 	function get_type(val: any): number;
 
+	/**
+	 * Returns the allocation counters of the native storage used by builtin value types.
+	 *
+	 * The result is keyed by type name, each entry has `live`, `recycled` and `allocated` counts.
+	 */
+	function get_builtin_payload_stats(): { [type: string]: { live: number, recycled: number, allocated: number } };
+
+	/**
+	 * Returns the cost of initializing the `godot` namespace.
+	 *
+	 * `initialize_memory` is only measured by debug builds of the engine. `created_classes` counts the engine
+	 * classes created so far, with `ecmascript/lazy_class_registration` they are created on first access.
+	 */
+	function get_startup_stats(): { lazy_class_registration: boolean, initialize_usec: number, initialize_memory: number, created_classes: number, total_classes: number };
+
+	/**
+	 * Returns the crossings between scripts and the engine counted during the last frame.
+	 *
+	 * The counters are only compiled in with `ecmascript_stats=yes`, other builds return an empty object.
+	 */
+	function ecmascript_stats(): { native_calls?: number, script_calls?: number, wrappers_created?: number, wrapper_hits?: number, container_copies?: number, payload_allocations?: number };
+
+	/**
+	 * Returns the memory of the script heap counted by its allocator.
+	 *
+	 * `size_histogram` counts the allocations by requested size: up to 16 bytes, up to 32 bytes and so on, the last
+	 * entry counts those larger than 16 KiB.
+	 */
+	function get_heap_stats(): { live_bytes: number, peak_bytes: number, live_allocations: number, total_allocations: number, size_histogram: number[] };
+
+	/**
+	 * Prints the memory of the script heap by kind of value (strings, objects, functions, bytecode, threads and
+	 * buffers) and the allocation size histogram.
+	 */
+	function dump_heap(): void;
+
+	/**
+	 * Returns a structured clone of `value`, the same copy a `Worker` message makes.
+	 *
+	 * Functions, godot objects and cyclic values can't be cloned. Pool arrays and TypedArray views of pool arrays
+	 * listed in `transfer` are moved instead of copied, the originals are left empty.
+	 */
+	function structured_clone<T>(value: T, transfer?: any[]): T;
+
+	/**
+	 * Runs the script at `path` in its own Duktape heap on a background thread.
+	 *
+	 * The worker script has `console`, `postMessage(data, transfer)`, `close()` and `onmessage` but no `godot`
+	 * namespace. Messages are structured clones: primitives, arrays, plain objects, typed arrays and builtin
+	 * values; pool arrays arrive in the worker as typed arrays. Replies are delivered once per frame.
+	 */
+	class Worker {
+		constructor(path: string);
+		/** Called on the main thread with each message posted by the worker */
+		onmessage: (data: any) => void;
+		/** Pool arrays and typed arrays in `transfer` are moved to the worker without copying their storage */
+		postMessage(data: any, transfer?: any[]): void;
+		/** Stops the worker thread, pending messages are dropped */
+		terminate(): void;
+	}
+
+	/**
+	 * Runs `fn` as a coroutine until it calls one of the wait functions, it is resumed from the frame loop.
+	 *
+	 * Waits must be called by ECMAScript code of the coroutine itself, not from callbacks called by native code
+	 * like `Array.prototype.forEach`. Errors thrown by the coroutine are printed and end it.
+	 */
+	function start_coroutine(fn: () => void): void;
+	/** Suspends the coroutine until `object` emits `signal`, returns the arguments of the signal */
+	function wait_signal(object: godot.Object, signal: string): any[];
+	/** Suspends the coroutine for at least `seconds` of real time */
+	function wait_seconds(seconds: number): void;
+	/** Suspends the coroutine until the next frame */
+	function wait_frame(): void;
+
+	/**
+	 * Truncate `value` to an integer and mark it as int.
+	 *
+	 * In engines built with `ecmascript_fastint=yes` the result is passed to godot as `int` instead of `float`.
+	 * Integer arithmetic results keep the mark, so only values computed by floating point math need it.
+	 */
+	function as_int(value: number): number;
+
 	/**
 	 Vector used for 2D math.
 
@@ -2024,11 +2107,14 @@ declare module godot {
 	 An [Array] specifically designed to hold bytes. Optimized for memory usage, does not fragment the memory. Note that this type is passed by value and not by reference. */
 	class PoolByteArray {
 		
-		constructor(from?:Array<number>|PoolByteArray);
+		constructor(from?:Array<number>|PoolByteArray|ArrayBufferView|ArrayBuffer);
 		
 		/** Get element at `index` */
 		get(index: number): number;
 
+		/** Returns a `Uint8Array` viewing the bytes of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Uint8Array;
+
 		/** Append an element at the end of the array (alias of [method push_back]). */
 		append(byte: number) : void;
 
@@ -2078,11 +2164,14 @@ declare module godot {
 	 An [Array] specifically designed to hold integer values ([int]). Optimized for memory usage, does not fragment the memory. Note that this type is passed by value and not by reference. */
 	class PoolIntArray {
 		
-		constructor(from?:Array<number>|PoolIntArray);
+		constructor(from?:Array<number>|PoolIntArray|ArrayBufferView|ArrayBuffer);
 		
 		/** Get element at `index` */
 		get(index: number): number;
 
+		/** Returns a `Int32Array` viewing the integers of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Int32Array;
+
 		/** Append an element at the end of the array (alias of [method push_back]). */
 		append(integer: number) : void;
 
@@ -2118,10 +2207,13 @@ declare module godot {
 	 An [Array] specifically designed to hold floating point values ([float]). Optimized for memory usage, does not fragment the memory. Note that this type is passed by value and not by reference. */
 	class PoolRealArray {
 
-		constructor(from?:Array<number>|PoolRealArray);
+		constructor(from?:Array<number>|PoolRealArray|ArrayBufferView|ArrayBuffer);
 		
 		/** Get element at `index` */
 		get(index: number): number;
+
+		/** Returns a `Float32Array` viewing the reals of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Float32Array;
 		
 		/** Append an element at the end of the array (alias of [method push_back]). */
 		append(value: number) : void;
@@ -2205,6 +2297,9 @@ declare module godot {
 		/** Get element at `index` */
 		get(index: number): Vector2;
 
+		/** Returns a `Float32Array` viewing the `x, y` pairs of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Float32Array;
+
 
 
 		/** Append an element at the end of the array (alias of [method push_back]). */
@@ -2246,6 +2341,9 @@ declare module godot {
 		/** Get element at `index` */
 		get(index: number): Vector3;
 
+		/** Returns a `Float32Array` viewing the `x, y, z` triples of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Float32Array;
+
 		/** Append an element at the end of the array (alias of [method push_back]). */
 		append(vector3: Vector3) : void;
 
@@ -2286,6 +2384,9 @@ declare module godot {
 		/** Get element at `index` */
 		get(index: number): Color;
 
+		/** Returns a `Float32Array` viewing the `r, g, b, a` quadruples of this array without copying. The memory is moved to the view and this array is left empty. */
+		as_typed_array(): Float32Array;
+
 		/** Append an element at the end of the array (alias of [method push_back]). */
 		append(color: Color) : void;
 
@@ -2316,3 +2417,10 @@ declare module godot {
 	}
 	
 }
+
+/** Calls `callback` with `args` after `delay` milliseconds, timers are run from the frame loop */
+declare function setTimeout(callback: (...args: any[]) => void, delay?: number, ...args: any[]): number;
+/** Calls `callback` with `args` every `delay` milliseconds, at most once per frame */
+declare function setInterval(callback: (...args: any[]) => void, delay?: number, ...args: any[]): number;
+declare function clearTimeout(id: number): void;
+declare function clearInterval(id: number): void;
@@ -0,0 +1,68 @@
+import { gdclass } from "../decorators";
+
+/**
+ * Scripts called back by native methods that scripts called.
+ *
+ * Attach to a node and run the scene. A script method emits a signal handled by another script, adds a script
+ * node whose _enter_tree and _ready run from add_child, and calls a script method through Object.call. Every
+ * check prints ok, a failed nested call prints its error instead.
+ */
+@gdclass("SignalReentryChild")
+class SignalReentryChild extends godot.Node {
+
+	entered = false;
+	is_ready = false;
+
+	_enter_tree() {
+		this.entered = true;
+	}
+
+	_ready() {
+		this.is_ready = true;
+	}
+
+	on_pinged(value: number) {
+		return value + 1;
+	}
+}
+
+@gdclass("SignalReentryTest")
+export default class SignalReentryTest extends godot.Node {
+
+	private received = 0;
+
+	_ready() {
+		this.add_user_signal("pinged");
+		this.connect("pinged", this, "on_pinged");
+
+		this.emit_signal("pinged", 41);
+		this.check("signal handled by a script", this.received == 41);
+
+		const child = new SignalReentryChild();
+		this.add_child(child);
+		this.check("_enter_tree and _ready run from add_child", child.entered && child.is_ready);
+
+		this.check("script method called through Object.call", child.call("on_pinged", 1) == 2);
+
+		const nested = new SignalReentryChild();
+		child.connect("tree_entered", this, "on_child_entered", [nested]);
+		child.add_child(nested);
+		this.remove_child(child);
+		this.add_child(child);
+		this.check("signal handler calling back into native methods", nested.is_ready && this.received == -1);
+		child.queue_free();
+	}
+
+	on_pinged(value: number) {
+		this.received = value;
+	}
+
+	on_child_entered(nested: SignalReentryChild) {
+		// Two suspended levels: the handler runs from add_child and emits again
+		this.emit_signal("pinged", nested.get_child_count() - 1);
+	}
+
+	private check(name: string, passed: boolean) {
+		console.log(`  ${passed ? "ok" : "FAILED"} ${name}`);
+	}
+}
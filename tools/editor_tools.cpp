@@ -69,6 +69,9 @@ ECMAScriptPlugin::ECMAScriptPlugin(EditorNode *p_node) {
 	eslib_inspector_plugin.instance();
 	EditorInspector::add_inspector_plugin(eslib_inspector_plugin);
 
+	export_plugin.instance();
+	add_export_plugin(export_plugin);
+
 	PopupMenu *menu = memnew(PopupMenu);
 	add_tool_submenu_item(TTR("ECMAScript"), menu);
 	menu->add_item(TTR("Reload All Cached Libraries"), ITEM_RELOAD_LIBS);
@@ -88,6 +91,25 @@ ECMAScriptPlugin::ECMAScriptPlugin(EditorNode *p_node) {
 	ProjectSettings::get_singleton()->set_custom_property_info("ecmascript/class_path", PropertyInfo(Variant::STRING, "ecmascript/class_path", PROPERTY_HINT_DIR));
 }
 
+void ECMAScriptExportPlugin::_export_file(const String &p_path, const String &p_type, const Set<String> &p_features) {
+
+	if (p_path.get_extension().to_lower() != "js" || !GLOBAL_GET("ecmascript/bytecode_cache")) {
+		return;
+	}
+
+	// Ship the compiled library next to its source, the loader checks it against the source hash
+	Error err;
+	String source = FileAccess::get_file_as_string(p_path, &err);
+	ERR_FAIL_COND(err != OK);
+
+	Vector<uint8_t> bytecode;
+	if (OK != ECMAScriptLanguage::get_singleton()->compile_to_bytecode(source, p_path, bytecode)) {
+		WARN_PRINTS("Exporting " + p_path + " without bytecode as it failed to compile");
+		return;
+	}
+	add_file(ECMAScriptLibrary::get_bytecode_path(p_path), ECMAScriptLibrary::encode_bytecode(source, bytecode), false);
+}
+
 void ECMAClassBrower::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_on_filter_changed"), &ECMAClassBrower::_on_filter_changed);
 	ClassDB::bind_method(D_METHOD("get_drag_data_fw"), &ECMAClassBrower::get_drag_data_fw);
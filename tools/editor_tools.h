@@ -1,5 +1,6 @@
 #ifndef ECMA_CLASS_BROWSER_H
 #define ECMA_CLASS_BROWSER_H
+#include "editor/editor_export.h"
 #include "editor/editor_file_dialog.h"
 #include "editor/editor_node.h"
 
@@ -37,6 +38,13 @@ public:
 	EditorInspectorPluginECMALib();
 };
 
+class ECMAScriptExportPlugin : public EditorExportPlugin {
+	GDCLASS(ECMAScriptExportPlugin, EditorExportPlugin);
+
+protected:
+	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features);
+};
+
 class ECMAScriptPlugin : public EditorPlugin {
 
 	GDCLASS(ECMAScriptPlugin, EditorPlugin);
@@ -50,6 +58,7 @@ class ECMAScriptPlugin : public EditorPlugin {
 	ECMAClassBrower *ecma_class_browser;
 	EditorFileDialog *declaration_file_dialog;
 	Ref<EditorInspectorPluginECMALib> eslib_inspector_plugin;
+	Ref<ECMAScriptExportPlugin> export_plugin;
 
 protected:
 	static String BUILTIN_DECLEARATION_TEXT;